@@ -28,11 +28,14 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <future>
 #include "tool_framework.h"
+#include "tool_reflection.h"
 #include <cross/spirv_hlsl.hpp>
 #include <cross/spirv_glsl.hpp>
 #include <cross/spirv_msl.hpp>
 #include <cross/spirv_common.hpp>
+#include <cross/spirv_parser.hpp>
 #include <cross/spirv.hpp>
 
 #include <shaderc/shaderc.hpp>
@@ -45,6 +48,98 @@ enum ShaderType
 	UNKNOWN_TYPE
 };
 
+//an editable specialization constant. the value is pushed into every cached compiler when it changes
+struct specConstant_t
+{
+	spirv_cross::ConstantID					id = {};
+	uint32_t								constantID = 0;
+	std::string								name = {};
+	spirv_cross::SPIRType::BaseType			baseType = spirv_cross::SPIRType::Unknown;
+	spirv_cross::SPIRConstant::Constant		value = {};
+	int										workGroupAxis = -1; //0, 1 or 2 if this constant drives local_size_x/y/z
+};
+
+//one pre-formatted row of the reflection panel
+struct reflectionRow_t
+{
+	enum column_t : unsigned int
+	{
+		index,
+		id,
+		name,
+		type,
+		binding,
+		numColumns
+	};
+
+	std::string								columns[numColumns] = {};
+	uint32_t								resource = 0; //index into reflectionIndex_t::resources
+};
+
+//a collapsible group of rows (atomics, push constants, ...) pointing into reflectionModel_t::rows
+struct reflectionCategory_t
+{
+	std::string								title = {};
+	unsigned int							firstRow = 0;
+	unsigned int							rowCount = 0;
+};
+
+//reflection info formatted once per module so drawing only touches the visible rows
+struct reflectionModel_t
+{
+	std::vector<std::string>				summary = {};
+	std::vector<reflectionRow_t>			rows = {};
+	std::vector<reflectionCategory_t>		categories = {};
+};
+
+//one validator message. the shown SPIR-V is recompiled from GLSL and won't line up, so the offending instruction is kept as text
+struct validationMessage_t
+{
+	std::string								text = {};
+	std::string								instruction = {}; //disassembled, empty if the message isn't about one
+	bool									error = false;
+};
+
+//what the SPIRV-Tools validator had to say about a binary. cached by the binary's hash and shared between modules
+struct validationResult_t
+{
+	size_t									wordCount = 0;
+	bool									valid = false;
+	std::vector<validationMessage_t>		messages = {};
+};
+
+//one row of the optimizer's per-pass report. times are negative when SPIRV-Tools was built without pass timers
+struct passReport_t
+{
+	std::string								name = {};
+	double									wallTime = -1.0; //seconds
+	double									cpuTime = -1.0; //seconds
+	long									rssDelta = 0; //KB, only measured along with the times
+	int										instructionsBefore = -1; //-1 when not counted
+	int										instructionsAfter = -1;
+};
+
+//the result of running an optimizer recipe over a module, built on a worker thread
+struct optimizedModule_t
+{
+	enum recipe_t : int
+	{
+		performance,
+		size,
+		legalization,
+		custom,
+		numRecipes
+	};
+
+	bool									succeeded = false;
+	std::string								messages = {};
+	std::vector<uint32_t>					binary = {};
+	std::string								spirvSource = {};
+	std::string								sources[UNKNOWN_TYPE] = {}; //indexed by ShaderType
+	std::vector<passReport_t>				passes = {};
+	double									wallTime = 0.0; //the whole run, validation and parsing included
+};
+
 //store type, binary and sources
 struct shaderModule_t
 {
@@ -69,9 +164,23 @@ struct shaderModule_t
 	std::string								spirvSource = {};
 	spirv_cross::ShaderResources			shaderResources = {};
 	spirv_cross::CompilerGLSL::Options		shaderOptions = {};
-	std::string								intPrecision = {};
-	std::string								floatPrecision = {};
+	reflectionIndex_t						reflectionIndex = {};
+	reflectionModel_t						reflection = {};
 	moduleType_t							moduleType = moduleType_t::invalid;
+
+	//compilers are kept alive after the first compile so a specialization constant edit only costs re-emission.
+	//the MSL backend rewrites its IR while compiling, so it is recreated from the cached parse before each emission
+	std::unique_ptr<spirv_cross::ParsedIR>		parsedIR;
+	std::unique_ptr<spirv_cross::CompilerGLSL>	glslCompiler;
+	std::unique_ptr<spirv_cross::CompilerHLSL>	hlslCompiler;
+	std::unique_ptr<spirv_cross::CompilerMSL>	mslCompiler;
+	std::vector<specConstant_t>				specConstants = {};
+	bool									staleSources[UNKNOWN_TYPE] = {}; //indexed by ShaderType
+
+	std::shared_ptr<const validationResult_t>	validation;
+	std::string								compileError = {}; //set when SPIRV-Cross gave up on the binary
+
+	std::shared_ptr<const optimizedModule_t>	optimized;
 };
 	//spv::ExecutionModel						
 // -------------------------------------------------------- PipelineLayoutTool -----------------------------------------------
@@ -82,9 +191,32 @@ class shaderTool_t : public ToolFramework
 	std::vector<shaderModule_t>				shaderModules;
 	ShaderType								shaderType = GLSL_TYPE;
 	const char*								currentItem = "GLSL source code";
-	const char*								entityItems[3] = { "GLSL source code","HLSL source code","MSL source code" };
+	const char*								entityItems[4] = { "GLSL source code","HLSL source code","MSL source code","Optimized" };
+	bool									showOptimized = false;
 
 	unsigned int currentModule = 0;
+
+	//block layout window state. the module and resource index into shaderModules/reflectionIndex_t::resources
+	int										layoutModule = -1;
+	int										layoutResource = -1;
+	char									layoutFilter[128] = {};
+	std::vector<uint32_t>					layoutMatches;
+
+	//validation results by binary hash, kept across loads so re-opening a file does not validate it again
+	std::unordered_map<uint64_t, std::shared_ptr<const validationResult_t>>	validationCache;
+
+	//optimized view settings. the optimizer runs on a worker thread for the module it was started on,
+	//loadCount tells whether that module has been replaced by a load since
+	int										optimizerRecipe = optimizedModule_t::performance;
+	char									customPasses[512] = {};
+	bool									countInstructions = true;
+	int										optimizedView = 0; //0 for SPIR-V, then GLSL, HLSL and MSL
+	std::vector<int>						passOrder; //sorted rows of the pass report
+	const optimizedModule_t*				passOrderSource = nullptr; //the report passOrder was built for
+	std::future<std::shared_ptr<const optimizedModule_t>>	pendingOptimization;
+	unsigned int							pendingOptimizationModule = 0;
+	unsigned int							pendingOptimizationLoad = 0;
+	unsigned int							loadCount = 0;
     // ---------------------- Names list UI helper ----------------------
 
     int DisplayNamedList(const char* title, const char* listboxName, const char* objname, const char* abbrev,
@@ -94,16 +226,31 @@ class shaderTool_t : public ToolFramework
 	void DrawMeta();
 	void DrawShaderTypes();
 	void DrawShaderReflection();
+	void DrawBlockLayout();
+	void DrawSpecConstants();
+	void DrawValidation();
 	void DrawSPIRV(ImVec2 dimensions);
 	void DrawHLSL(ImVec2 dimensions);
 	void DrawGLSL(ImVec2 dimensions);
 	void DrawMSL(ImVec2 dimensions);
+	void DrawOptimized(ImVec2 dimensions);
+	void DrawPassReport(const optimizedModule_t& optimized, float height);
 
 	bool CheckShaderType(shaderModule_t& module, shaderc::AssemblyCompilationResult& result);
 	void DetermineShaderModuleType(shaderModule_t& module, spv::ExecutionModel model);
 	void CompileAll(std::vector<uint32_t>& spv, shaderModule_t& module);
+	void CompileTargets(shaderModule_t& module);
+	void CollectSpecConstants(shaderModule_t& module);
+	void BuildReflectionModel(shaderModule_t& module);
+	void ApplySpecConstant(shaderModule_t& module, const specConstant_t& constant);
+	void ResetMSLCompiler(shaderModule_t& module);
+	void EmitSource(shaderModule_t& module, ShaderType type);
+	void StartOptimization();
+	void PollOptimization();
 
 	void Save(std::string fileName);
+	void ExportSources(std::string fileName);
+	void ExportReflection(std::string fileName);
 	void Load(std::string fileName);
 
 	std::vector<uint32_t> ReadSPIRVFile(const char* fileName);
@@ -0,0 +1,111 @@
+/*
+ Copyright (c) 2021 UAA Software
+ 
+ Permission is hereby granted, free of charge, to any person obtaining
+ a copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TOOL_REFLECTION_
+#define TOOL_REFLECTION_
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <cross/spirv_cross.hpp>
+#include <json/json.h>
+
+//the ShaderResources list a resource came from
+enum resourceKind_t : unsigned int
+{
+	atomicCounter,
+	pushConstantBuffer,
+	sampledImage,
+	stageInput,
+	stageOutput,
+	storageBuffer,
+	storageImage,
+	subpassInput,
+	uniformBuffer,
+	separateImage,
+	separateSampler,
+	accelerationStructure,
+	numResourceKinds
+};
+
+//a member of a block, flattened depth first. offsets are relative to the start of the block
+struct blockMember_t
+{
+	std::string								name = {}; //full path from the block, e.g. "lights[0].color"
+	std::string								typeName = {};
+	uint32_t								typeID = 0;
+	uint32_t								resource = 0; //index into reflectionIndex_t::resources
+	uint32_t								depth = 0;
+	uint32_t								offset = 0;
+	uint32_t								size = 0;
+	uint32_t								arrayStride = 0;
+	uint32_t								matrixStride = 0;
+};
+
+struct reflectedResource_t
+{
+	resourceKind_t							kind = numResourceKinds;
+	std::string								name = {};
+	std::string								typeName = {};
+	uint32_t								id = 0;
+	uint32_t								typeID = 0;
+	uint32_t								baseTypeID = 0;
+	uint32_t								set = (uint32_t)-1;
+	uint32_t								binding = (uint32_t)-1;
+	uint32_t								location = (uint32_t)-1;
+	uint32_t								size = 0; //declared size of the block, 0 for non-blocks
+	uint32_t								firstMember = 0;
+	uint32_t								memberCount = 0;
+};
+
+//every resource and block member of a module, computed once and stored in flat arrays
+class reflectionIndex_t
+{
+	std::unordered_map<std::string, uint32_t>	resourceLookup;
+	std::unordered_map<std::string, uint32_t>	memberLookup; //keyed by "block.member.path"
+
+	void AddResources(const spirv_cross::Compiler& compiler, resourceKind_t kind, const spirv_cross::SmallVector<spirv_cross::Resource>& list);
+	void AddMembers(const spirv_cross::Compiler& compiler, const spirv_cross::SPIRType& structType, const std::string& prefix,
+		uint32_t baseOffset, uint32_t depth, uint32_t resource, bool hasLayout);
+
+public:
+	static const uint32_t unassigned = (uint32_t)-1;
+
+	std::vector<reflectedResource_t>		resources;
+	std::vector<blockMember_t>				members;
+
+	void Build(const spirv_cross::Compiler& compiler, const spirv_cross::ShaderResources& shaderResources);
+	void Clear();
+
+	//exact name lookups, nullptr if nothing matches
+	const reflectedResource_t* FindResource(const std::string& name) const;
+	const blockMember_t* FindMember(const std::string& blockName, const std::string& memberPath) const;
+	//indices of the members of a resource whose path contains text
+	void SearchMembers(uint32_t resource, const std::string& text, std::vector<uint32_t>& matches) const;
+
+	Json::Value ToJson() const;
+
+	static const char* KindName(resourceKind_t kind);
+};
+
+#endif //TOOL_REFLECTION_
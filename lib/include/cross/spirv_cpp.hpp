@@ -52,6 +52,7 @@ public:
 	{
 	}
 
+	using CompilerGLSL::compile;
 	std::string compile() override;
 
 	// Sets a custom symbol name that can override
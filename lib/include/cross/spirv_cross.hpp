@@ -148,6 +148,14 @@ public:
 	// Sub-classes actually implement this.
 	virtual std::string compile();
 
+	// Receives compiled source in order, one chunk at a time.
+	typedef std::function<void(const char *data, size_t size)> OutputSink;
+
+	// Same as compile(), but the output is handed to sink chunk by chunk instead of
+	// being concatenated into a single string. Backends which buffer their output
+	// in blocks pass those blocks straight through, so peak memory stays at one copy.
+	virtual void compile(const OutputSink &sink);
+
 	// Gets the identifier (OpName) of an ID. If not defined, an empty string will be returned.
 	const std::string &get_name(ID id) const;
 
@@ -686,6 +686,18 @@ public:
 		return ret;
 	}
 
+	// Hands every block to func in order without building a contiguous copy.
+	// func is called as func(const char *data, size_t size).
+	template <typename Func>
+	void for_each_block(const Func &func) const
+	{
+		for (auto &saved : saved_buffers)
+			if (saved.offset)
+				func(saved.buffer, saved.offset);
+		if (current_buffer.offset)
+			func(current_buffer.buffer, current_buffer.offset);
+	}
+
 	void reset()
 	{
 		for (auto &saved : saved_buffers)
@@ -214,6 +214,7 @@ public:
 	}
 
 	std::string compile() override;
+	void compile(const OutputSink &sink) override;
 
 	// Returns the current string held in the conversion buffer. Useful for
 	// capturing what has been converted so far when compile() throws an error.
@@ -425,6 +426,11 @@ protected:
 
 	StringStream<> buffer;
 
+	// Set while compile(const OutputSink &) is running. The backend's compile() then
+	// leaves its output in buffer instead of copying it out.
+	bool stream_output = false;
+	std::string get_compiled_source() const;
+
 	template <typename T>
 	inline void statement_inner(T &&t)
 	{
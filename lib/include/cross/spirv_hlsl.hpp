@@ -180,6 +180,7 @@ public:
 	// Matrices are unrolled to vectors with notation ${SEMANTIC}_#, where # denotes row.
 	// $SEMANTIC is either TEXCOORD# or a semantic name specified here.
 	void add_vertex_attribute_remap(const HLSLVertexAttributeRemap &vertex_attributes);
+	using CompilerGLSL::compile;
 	std::string compile() override;
 
 	// This is a special HLSL workaround for the NumWorkGroups builtin.
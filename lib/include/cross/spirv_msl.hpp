@@ -578,6 +578,7 @@ public:
 	uint32_t get_automatic_msl_resource_binding_quaternary(uint32_t id) const;
 
 	// Compiles the SPIR-V code into Metal Shading Language.
+	using CompilerGLSL::compile;
 	std::string compile() override;
 
 	// Remap a sampler with ID to a constexpr sampler.
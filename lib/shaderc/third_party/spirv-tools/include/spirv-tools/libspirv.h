@@ -333,6 +333,10 @@ typedef enum spv_binary_to_text_options_t {
   SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES = SPV_BIT(6),
   // Add some comments to the generated assembly
   SPV_BINARY_TO_TEXT_OPTION_COMMENT = SPV_BIT(7),
+  // Disassemble function bodies on multiple threads when the module is large
+  // enough.  The text is identical to a serial disassembly.  Ignored when
+  // printing.
+  SPV_BINARY_TO_TEXT_OPTION_PARALLEL = SPV_BIT(8),
   SPV_FORCE_32_BIT_ENUM(spv_binary_to_text_options_t)
 } spv_binary_to_text_options_t;
 
@@ -636,6 +640,11 @@ SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetWorkgroupScalarBlockLayout(
 SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetSkipBlockLayout(
     spv_validator_options options, bool val);
 
+// Records whether the validator should check function bodies on multiple
+// threads.  The result and diagnostics are the same as validating serially.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetParallel(
+    spv_validator_options options, bool val);
+
 // Creates an optimizer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvOptimizerOptionsDestroy|.
@@ -668,6 +677,11 @@ SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveBindings(
 SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveSpecConstants(
     spv_optimizer_options options, bool val);
 
+// Records whether passes that support it should analyze functions on
+// multiple threads.  The result is the same as optimizing serially.
+SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetParallelFunctions(
+    spv_optimizer_options options, bool val);
+
 // Creates a reducer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvReducerOptionsDestroy|.
@@ -695,6 +709,16 @@ SPIRV_TOOLS_EXPORT void spvReducerOptionsSetFailOnValidationError(
 SPIRV_TOOLS_EXPORT void spvReducerOptionsSetTargetFunction(
     spv_reducer_options options, uint32_t target_function);
 
+// Sets how many reduction steps the reducer may try at once.  Each step applies
+// a different chunk of reduction opportunities to the same binary; the steps
+// are validated and checked for interestingness on separate threads, so the
+// interestingness function must be safe to call concurrently.  The first
+// interesting step, in the order the steps would be tried one at a time, is
+// kept, so the result and the steps counted are the same as with the default
+// of 1, which tries one step at a time.
+SPIRV_TOOLS_EXPORT void spvReducerOptionsSetParallelCandidates(
+    spv_reducer_options options, uint32_t parallel_candidates);
+
 // Creates a fuzzer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvFuzzerOptionsDestroy|.
@@ -115,6 +115,10 @@ class ValidatorOptions {
     spvValidatorOptionsSetSkipBlockLayout(options_, val);
   }
 
+  // Checks function bodies on multiple threads.  The result and diagnostics
+  // are the same as validating serially.
+  void SetParallel(bool val) { spvValidatorOptionsSetParallel(options_, val); }
+
   // Records whether or not the validator should relax the rules on pointer
   // usage in logical addressing mode.
   //
@@ -182,6 +186,12 @@ class OptimizerOptions {
                                                 preserve_spec_constants);
   }
 
+  // Analyzes functions on multiple threads in passes that support it.  The
+  // result is the same as optimizing serially.
+  void set_parallel_functions(bool parallel_functions) {
+    spvOptimizerOptionsSetParallelFunctions(options_, parallel_functions);
+  }
+
  private:
   spv_optimizer_options options_;
 };
@@ -213,6 +223,11 @@ class ReducerOptions {
     spvReducerOptionsSetTargetFunction(options_, target_function);
   }
 
+  // See spvReducerOptionsSetParallelCandidates.
+  void set_parallel_candidates(uint32_t parallel_candidates) {
+    spvReducerOptionsSetParallelCandidates(options_, parallel_candidates);
+  }
+
  private:
   spv_reducer_options options_;
 };
@@ -323,6 +338,17 @@ class SpirvTools {
                    std::string* text,
                    uint32_t options = kDefaultDisassembleOption) const;
 
+  // Like Disassemble, and also stores in |line_offsets| the offset into |text|
+  // at which each line of the assembly starts, so that callers can address
+  // lines without scanning the text.  Both are kept untouched if disassembling
+  // is unsuccessful.
+  bool Disassemble(const std::vector<uint32_t>& binary, std::string* text,
+                   std::vector<size_t>* line_offsets, uint32_t options) const;
+  // |binary_size| specifies the number of words in |binary|.
+  bool Disassemble(const uint32_t* binary, size_t binary_size,
+                   std::string* text, std::vector<size_t>* line_offsets,
+                   uint32_t options) const;
+
   // Validates the given SPIR-V |binary|. Returns true if no issues are found.
   // Otherwise, returns false and communicates issues via the message consumer
   // registered.
@@ -29,7 +29,8 @@ class LinkerOptions {
   LinkerOptions()
       : create_library_(false),
         verify_ids_(false),
-        allow_partial_linkage_(false) {}
+        allow_partial_linkage_(false),
+        deduplicate_while_merging_(false) {}
 
   // Returns whether a library or an executable should be produced by the
   // linking phase.
@@ -63,10 +64,25 @@ class LinkerOptions {
     allow_partial_linkage_ = allow_partial_linkage;
   }
 
+  // Returns whether duplicate types, constants and decorations are dropped
+  // while the modules are merged, instead of by a separate pass afterwards.
+  // Parsing, ID shifting and function copying are then done in parallel, one
+  // input module at a time per thread.
+  bool GetDeduplicateWhileMerging() const {
+    return deduplicate_while_merging_;
+  }
+
+  // Sets whether duplicate types, constants and decorations are dropped while
+  // the modules are merged.
+  void SetDeduplicateWhileMerging(bool deduplicate_while_merging) {
+    deduplicate_while_merging_ = deduplicate_while_merging;
+  }
+
  private:
   bool create_library_;
   bool verify_ids_;
   bool allow_partial_linkage_;
+  bool deduplicate_while_merging_;
 };
 
 // Links one or more SPIR-V modules into a new SPIR-V module. That is, combine
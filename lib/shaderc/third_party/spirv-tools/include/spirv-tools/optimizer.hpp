@@ -214,6 +214,24 @@ class Optimizer {
   // Sets the option to validate the module after each pass.
   Optimizer& SetValidateAfterAll(bool validate);
 
+  // Sets the option to skip a registered pass when a pass with the same name
+  // already ran without changing the module, and no pass changed it since.
+  // The result is the same as running every pass, so this mainly speeds up
+  // recipes that repeat passes, most of all on modules that are already
+  // optimized.  Skipped passes are not printed or timed.
+  Optimizer& SetSkipUnchangedPasses(bool skip);
+
+  // Sets a directory in which Run keeps its results, so they can be reused by
+  // later runs in this or another process.  A result is found by the input
+  // binary, the target environment, the optimizer options and the registered
+  // passes.  On a hit the stored binary is returned without validating or
+  // optimizing, and no pass is printed or timed.
+  //
+  // Only passes registered through flags or the Register*Passes() recipes are
+  // known by their settings.  A run with any other registered pass neither
+  // reads nor writes the cache.  An empty |path| turns the cache off.
+  Optimizer& SetCacheDirectory(const std::string& path);
+
  private:
   struct Impl;                  // Opaque struct for holding internal data.
   std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
@@ -196,6 +196,15 @@ spv_result_t AssemblyGrammar::lookupOpcode(const char* name,
 
 spv_result_t AssemblyGrammar::lookupOpcode(SpvOp opcode,
                                            spv_opcode_desc* desc) const {
+  if (grammarIndex_ && desc) {
+    const auto& opcodes = grammarIndex_->opcodes;
+    const auto value = static_cast<uint32_t>(opcode);
+    if (value >= opcodes.size() || !opcodes[value]) {
+      return SPV_ERROR_INVALID_LOOKUP;
+    }
+    *desc = opcodes[value];
+    return SPV_SUCCESS;
+  }
   return spvOpcodeTableValueLookup(target_env_, opcodeTable_, opcode, desc);
 }
 
@@ -209,6 +218,16 @@ spv_result_t AssemblyGrammar::lookupOperand(spv_operand_type_t type,
 spv_result_t AssemblyGrammar::lookupOperand(spv_operand_type_t type,
                                             uint32_t operand,
                                             spv_operand_desc* desc) const {
+  if (grammarIndex_ && desc &&
+      static_cast<size_t>(type) < grammarIndex_->operands.size()) {
+    const auto& values = grammarIndex_->operands[type];
+    if (operand < values.entries.size()) {
+      if (!values.entries[operand]) return SPV_ERROR_INVALID_LOOKUP;
+      *desc = values.entries[operand];
+      return SPV_SUCCESS;
+    }
+    if (values.complete) return SPV_ERROR_INVALID_LOOKUP;
+  }
   return spvOperandTableValueLookup(target_env_, operandTable_, type, operand,
                                     desc);
 }
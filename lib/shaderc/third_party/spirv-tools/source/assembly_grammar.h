@@ -31,7 +31,8 @@ class AssemblyGrammar {
       : target_env_(context->target_env),
         operandTable_(context->operand_table),
         opcodeTable_(context->opcode_table),
-        extInstTable_(context->ext_inst_table) {}
+        extInstTable_(context->ext_inst_table),
+        grammarIndex_(context->grammar_index) {}
 
   // Returns true if the internal tables have been initialized with valid data.
   bool isValid() const;
@@ -131,6 +132,8 @@ class AssemblyGrammar {
   const spv_operand_table operandTable_;
   const spv_opcode_table opcodeTable_;
   const spv_ext_inst_table extInstTable_;
+  // Direct lookups for opcode and operand values, may be null.
+  const spv_grammar_index grammarIndex_;
 };
 
 }  // namespace spvtools
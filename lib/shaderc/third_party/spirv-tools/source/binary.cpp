@@ -73,6 +73,7 @@ class Parser {
          spv_parsed_header_fn_t parsed_header_fn,
          spv_parsed_instruction_fn_t parsed_instruction_fn)
       : grammar_(context),
+        opcode_table_(context->opcode_table),
         consumer_(context->consumer),
         user_data_(user_data),
         parsed_header_fn_(parsed_header_fn),
@@ -84,12 +85,55 @@ class Parser {
   spv_result_t parse(const uint32_t* words, size_t num_words,
                      spv_diagnostic* diagnostic);
 
+  // Parses the header and the instructions in the first prefix_end words of
+  // the module, issuing callbacks as for parse.  The parse state is kept, so
+  // that other parsers can continue from it with parseRange.
+  spv_result_t parsePrefix(const uint32_t* words, size_t num_words,
+                           size_t prefix_end);
+
+  // Parses the instructions in words [begin, end) of the module whose prefix
+  // was parsed by |prefix|, issuing callbacks for each instruction.  The
+  // parse continues from the prefix's state, without seeing any instruction
+  // between the prefix and begin.  The state is kept for definedIds.
+  spv_result_t parseRange(const Parser& prefix, size_t begin, size_t end);
+
+  // Appends the result Ids defined by the last parseRange to *ids.
+  void definedIds(std::vector<uint32_t>* ids) const {
+    for (const auto& entry : _.id_to_type_id) ids->push_back(entry.first);
+  }
+
  private:
+  // The operand layout of an opcode whose operands are all single words that
+  // need no grammar lookups: a fixed run of Ids and literal integers,
+  // optionally followed by any number of words of one such type.
+  struct SimpleLayout {
+    bool eligible;
+    uint16_t num_fixed;  // Leading entries of the opcode's operandTypes.
+    spv_operand_type_t tail;  // SPV_OPERAND_TYPE_NONE if there is no tail.
+  };
+
+  // Instructions with more operands than this take the general path.
+  static const size_t kMaxSimpleOperands = 32;
+
+  // Returns the layouts of the opcode table entries, in table order.  The
+  // opcode table is the same for all target environments, so this is computed
+  // once per process.
+  static const std::vector<SimpleLayout>& simpleLayouts(
+      spv_opcode_table opcode_table);
+
   // All remaining methods work on the current module parse state.
 
   // Like the parse method, but works on the current module parse state.
   spv_result_t parseModule();
 
+  // Checks the module header, sets the endianness and issues the parsed
+  // header callback.
+  spv_result_t parseHeader();
+
+  // Parses instructions from the current position up to the given word
+  // index, which must be an instruction boundary.
+  spv_result_t parseInstructions(size_t end);
+
   // Parses an instruction at the current position of the binary.  Assumes
   // the header has been parsed, the endian has been set, and the word index is
   // still in range.  Advances the parsing position past the instruction, and
@@ -98,6 +142,20 @@ class Parser {
   // On failure, returns an error code and issues a diagnostic.
   spv_result_t parseInstruction();
 
+  // Parses the instruction at the current position without going through the
+  // expected-operand pattern, if its opcode has a simple layout (see
+  // SimpleLayout) and the binary is in host native endianness.  The operands
+  // are decoded into a stack buffer and the instruction words point into the
+  // binary.  Returns false, without changing any parse state, if the
+  // instruction is not eligible or anything about it looks wrong; parsing
+  // must then continue on the general path, which also reports the errors.
+  // Otherwise returns true and sets *result to the outcome of the
+  // parsed-instruction callback.
+  bool parseSimpleInstruction(spv_opcode_desc opcode_desc,
+                              uint16_t inst_word_count,
+                              spv_parsed_instruction_t* inst,
+                              spv_result_t* result);
+
   // Parses an instruction operand with the given type, for an instruction
   // starting at inst_offset words into the SPIR-V binary.
   // If the SPIR-V binary is the same endianness as the host, then the
@@ -169,6 +227,7 @@ class Parser {
   // Data members
 
   const spvtools::AssemblyGrammar grammar_;        // SPIR-V syntax utility.
+  const spv_opcode_table opcode_table_;            // Grammar opcode table.
   const spvtools::MessageConsumer& consumer_;      // Message consumer callback.
   void* const user_data_;                          // Context for the callbacks
   const spv_parsed_header_fn_t parsed_header_fn_;  // Parsed header callback
@@ -191,7 +250,8 @@ class Parser {
           word_index(0),
           instruction_count(0),
           endian(),
-          requires_endian_conversion(false) {
+          requires_endian_conversion(false),
+          prefix(nullptr) {
       // Temporary storage for parser state within a single instruction.
       // Most instructions require fewer than 25 words or operands.
       operands.reserve(25);
@@ -219,6 +279,32 @@ class Parser {
     std::unordered_map<uint32_t, spv_ext_inst_type_t>
         import_id_to_ext_inst_type;
 
+    // When parsing a range of instructions after the module prefix, the
+    // state left by parsing the prefix.  The lookups below fall back to it.
+    const State* prefix;
+
+    // Returns the type Id recorded for the given result Id, or null if the Id
+    // has not been defined.
+    const uint32_t* findTypeIdOf(uint32_t id) const {
+      const auto iter = id_to_type_id.find(id);
+      if (iter != id_to_type_id.end()) return &iter->second;
+      return prefix ? prefix->findTypeIdOf(id) : nullptr;
+    }
+    // Returns the number type of the given type Id, or null if it is not a
+    // type.
+    const NumberType* findNumberType(uint32_t type_id) const {
+      const auto iter = type_id_to_number_type_info.find(type_id);
+      if (iter != type_id_to_number_type_info.end()) return &iter->second;
+      return prefix ? prefix->findNumberType(type_id) : nullptr;
+    }
+    // Returns the extended instruction type imported by the given Id, or null
+    // if it is not an OpExtInstImport result.
+    const spv_ext_inst_type_t* findExtInstType(uint32_t import_id) const {
+      const auto iter = import_id_to_ext_inst_type.find(import_id);
+      if (iter != import_id_to_ext_inst_type.end()) return &iter->second;
+      return prefix ? prefix->findExtInstType(import_id) : nullptr;
+    }
+
     // Used by parseOperand
     std::vector<spv_parsed_operand_t> operands;
     std::vector<uint32_t> endian_converted_words;
@@ -238,7 +324,45 @@ spv_result_t Parser::parse(const uint32_t* words, size_t num_words,
   return result;
 }
 
+spv_result_t Parser::parsePrefix(const uint32_t* words, size_t num_words,
+                                 size_t prefix_end) {
+  _ = State(words, num_words, nullptr);
+  if (auto error = parseHeader()) return error;
+  _.word_index = SPV_INDEX_INSTRUCTION;
+  return parseInstructions(prefix_end);
+}
+
+spv_result_t Parser::parseRange(const Parser& prefix, size_t begin,
+                                size_t end) {
+  // Reading past the end of the range is reported as running out of input.
+  _ = State(prefix._.words, end, nullptr);
+  _.endian = prefix._.endian;
+  _.requires_endian_conversion = prefix._.requires_endian_conversion;
+  _.prefix = &prefix._;
+  _.word_index = begin;
+  return parseInstructions(end);
+}
+
 spv_result_t Parser::parseModule() {
+  if (auto error = parseHeader()) return error;
+
+  // Process the instructions.
+  _.word_index = SPV_INDEX_INSTRUCTION;
+  if (auto error = parseInstructions(_.num_words)) return error;
+
+  // Running off the end should already have been reported earlier.
+  assert(_.word_index == _.num_words);
+
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::parseInstructions(size_t end) {
+  while (_.word_index < end)
+    if (auto error = parseInstruction()) return error;
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::parseHeader() {
   if (!_.words) return diagnostic() << "Missing module.";
 
   if (_.num_words < SPV_INDEX_INSTRUCTION)
@@ -269,14 +393,6 @@ spv_result_t Parser::parseModule() {
     }
   }
 
-  // Process the instructions.
-  _.word_index = SPV_INDEX_INSTRUCTION;
-  while (_.word_index < _.num_words)
-    if (auto error = parseInstruction()) return error;
-
-  // Running off the end should already have been reported earlier.
-  assert(_.word_index == _.num_words);
-
   return SPV_SUCCESS;
 }
 
@@ -289,16 +405,6 @@ spv_result_t Parser::parseInstruction() {
 
   const uint32_t first_word = peek();
 
-  // If the module's endianness is different from the host native endianness,
-  // then converted_words contains the the endian-translated words in the
-  // instruction.
-  _.endian_converted_words.clear();
-  _.endian_converted_words.push_back(first_word);
-
-  // After a successful parse of the instruction, the inst.operands member
-  // will point to this vector's storage.
-  _.operands.clear();
-
   assert(_.word_index < _.num_words);
   // Decompose and check the first word.
   uint16_t inst_word_count = 0;
@@ -311,6 +417,23 @@ spv_result_t Parser::parseInstruction() {
   if (grammar_.lookupOpcode(static_cast<SpvOp>(inst.opcode), &opcode_desc))
     return diagnostic() << "Invalid opcode: " << inst.opcode;
 
+  spv_result_t simple_result = SPV_SUCCESS;
+  if (!_.requires_endian_conversion &&
+      parseSimpleInstruction(opcode_desc, inst_word_count, &inst,
+                             &simple_result)) {
+    return simple_result;
+  }
+
+  // If the module's endianness is different from the host native endianness,
+  // then converted_words contains the the endian-translated words in the
+  // instruction.
+  _.endian_converted_words.clear();
+  _.endian_converted_words.push_back(first_word);
+
+  // After a successful parse of the instruction, the inst.operands member
+  // will point to this vector's storage.
+  _.operands.clear();
+
   // Advance past the opcode word.  But remember the of the start
   // of the instruction.
   const size_t inst_offset = _.word_index;
@@ -402,6 +525,122 @@ spv_result_t Parser::parseInstruction() {
   return SPV_SUCCESS;
 }
 
+const std::vector<Parser::SimpleLayout>& Parser::simpleLayouts(
+    spv_opcode_table opcode_table) {
+  static const std::vector<SimpleLayout> layouts = [opcode_table]() {
+    std::vector<SimpleLayout> result(opcode_table->count);
+    for (uint32_t i = 0; i < opcode_table->count; ++i) {
+      const spv_opcode_desc_t& entry = opcode_table->entries[i];
+      SimpleLayout layout = {true, 0, SPV_OPERAND_TYPE_NONE};
+      for (uint16_t j = 0; j < entry.numTypes && layout.eligible; ++j) {
+        const bool last = j + 1 == entry.numTypes;
+        switch (entry.operandTypes[j]) {
+          case SPV_OPERAND_TYPE_TYPE_ID:
+          case SPV_OPERAND_TYPE_RESULT_ID:
+          case SPV_OPERAND_TYPE_ID:
+          case SPV_OPERAND_TYPE_SCOPE_ID:
+          case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
+          case SPV_OPERAND_TYPE_LITERAL_INTEGER:
+            layout.num_fixed++;
+            break;
+          // These expand to any number of optional Ids or literal integers,
+          // which are reported with the concrete type.
+          case SPV_OPERAND_TYPE_VARIABLE_ID:
+            layout.eligible = last;
+            layout.tail = SPV_OPERAND_TYPE_ID;
+            break;
+          case SPV_OPERAND_TYPE_VARIABLE_LITERAL_INTEGER:
+            layout.eligible = last;
+            layout.tail = SPV_OPERAND_TYPE_LITERAL_INTEGER;
+            break;
+          default:
+            layout.eligible = false;
+            break;
+        }
+      }
+      result[i] = layout;
+    }
+    return result;
+  }();
+  // There is only one opcode table.
+  assert(layouts.size() == opcode_table->count);
+  return layouts;
+}
+
+bool Parser::parseSimpleInstruction(spv_opcode_desc opcode_desc,
+                                    uint16_t inst_word_count,
+                                    spv_parsed_instruction_t* inst,
+                                    spv_result_t* result) {
+  const auto& layouts = simpleLayouts(opcode_table_);
+  const size_t entry_index = size_t(opcode_desc - opcode_table_->entries);
+  if (entry_index >= layouts.size()) return false;
+  const SimpleLayout& layout = layouts[entry_index];
+  if (!layout.eligible) return false;
+
+  const size_t inst_offset = _.word_index;
+  const size_t num_operands = size_t(inst_word_count) - 1;
+  if (inst_offset + inst_word_count > _.num_words) return false;
+  if (num_operands < layout.num_fixed || num_operands > kMaxSimpleOperands)
+    return false;
+  if (num_operands > layout.num_fixed && layout.tail == SPV_OPERAND_TYPE_NONE)
+    return false;
+
+  const uint32_t* const words = _.words + inst_offset;
+  spv_parsed_operand_t operands[kMaxSimpleOperands];
+  uint32_t type_id = 0;
+  uint32_t result_id = 0;
+  for (size_t i = 0; i < num_operands; ++i) {
+    const uint32_t word = words[i + 1];
+    const spv_operand_type_t type =
+        i < layout.num_fixed ? opcode_desc->operandTypes[i] : layout.tail;
+    spv_parsed_operand_t& parsed_operand = operands[i];
+    parsed_operand.offset = uint16_t(i + 1);
+    parsed_operand.num_words = 1;
+    parsed_operand.type = type;
+    parsed_operand.number_kind = SPV_NUMBER_NONE;
+    parsed_operand.number_bit_width = 0;
+    switch (type) {
+      case SPV_OPERAND_TYPE_TYPE_ID:
+        if (!word) return false;
+        type_id = word;
+        break;
+      case SPV_OPERAND_TYPE_RESULT_ID:
+        if (!word || _.findTypeIdOf(word)) return false;
+        result_id = word;
+        break;
+      case SPV_OPERAND_TYPE_LITERAL_INTEGER:
+        parsed_operand.number_kind = SPV_NUMBER_UNSIGNED_INT;
+        parsed_operand.number_bit_width = 32;
+        break;
+      default:
+        if (!word) return false;
+        break;
+    }
+  }
+
+  // The instruction is well formed, commit it.
+  inst->type_id = type_id;
+  inst->result_id = result_id;
+  if (result_id) {
+    _.id_to_type_id[result_id] =
+        spvOpcodeGeneratesType(static_cast<SpvOp>(inst->opcode)) ? result_id
+                                                                 : type_id;
+  }
+  recordNumberType(inst_offset, inst);
+  _.word_index = inst_offset + inst_word_count;
+
+  inst->words = words;
+  inst->num_words = inst_word_count;
+  inst->operands = operands;
+  inst->num_operands = uint16_t(num_operands);
+
+  *result = SPV_SUCCESS;
+  if (parsed_instruction_fn_) {
+    *result = parsed_instruction_fn_(user_data_, inst);
+  }
+  return true;
+}
+
 spv_result_t Parser::parseOperand(size_t inst_offset,
                                   spv_parsed_instruction_t* inst,
                                   const spv_operand_type_t type,
@@ -447,7 +686,7 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       inst->result_id = word;
       // Save the result ID to type ID mapping.
       // In the grammar, type ID always appears before result ID.
-      if (_.id_to_type_id.find(inst->result_id) != _.id_to_type_id.end())
+      if (_.findTypeIdOf(inst->result_id))
         return diagnostic(SPV_ERROR_INVALID_ID)
                << "Id " << inst->result_id << " is defined more than once";
       // Record it.
@@ -466,13 +705,13 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       if (opcode == SpvOpExtInst && parsed_operand.offset == 3) {
         // The current word is the extended instruction set Id.
         // Set the extended instruction set type for the current instruction.
-        auto ext_inst_type_iter = _.import_id_to_ext_inst_type.find(word);
-        if (ext_inst_type_iter == _.import_id_to_ext_inst_type.end()) {
+        const spv_ext_inst_type_t* ext_inst_type = _.findExtInstType(word);
+        if (!ext_inst_type) {
           return diagnostic(SPV_ERROR_INVALID_ID)
                  << "OpExtInst set Id " << word
                  << " does not reference an OpExtInstImport result Id";
         }
-        inst->ext_inst_type = ext_inst_type_iter->second;
+        inst->ext_inst_type = *ext_inst_type;
       }
       break;
 
@@ -542,13 +781,12 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
         // The literal operands have the same type as the value
         // referenced by the selector Id.
         const uint32_t selector_id = peekAt(inst_offset + 1);
-        const auto type_id_iter = _.id_to_type_id.find(selector_id);
-        if (type_id_iter == _.id_to_type_id.end() ||
-            type_id_iter->second == 0) {
+        const uint32_t* selector_type_id = _.findTypeIdOf(selector_id);
+        if (!selector_type_id || *selector_type_id == 0) {
           return diagnostic() << "Invalid OpSwitch: selector id " << selector_id
                               << " has no type";
         }
-        uint32_t type_id = type_id_iter->second;
+        uint32_t type_id = *selector_type_id;
 
         if (selector_id == type_id) {
           // Recall that by convention, a result ID that is a type definition
@@ -761,11 +999,11 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
 spv_result_t Parser::setNumericTypeInfoForType(
     spv_parsed_operand_t* parsed_operand, uint32_t type_id) {
   assert(type_id != 0);
-  auto type_info_iter = _.type_id_to_number_type_info.find(type_id);
-  if (type_info_iter == _.type_id_to_number_type_info.end()) {
+  const NumberType* type_info = _.findNumberType(type_id);
+  if (!type_info) {
     return diagnostic() << "Type Id " << type_id << " is not a type";
   }
-  const NumberType& info = type_info_iter->second;
+  const NumberType& info = *type_info;
   if (info.type == SPV_NUMBER_NONE) {
     // This is a valid type, but for something other than a scalar number.
     return diagnostic() << "Type Id " << type_id
@@ -813,6 +1051,115 @@ spv_result_t spvBinaryParse(const spv_const_context context, void* user_data,
   return parser.parse(code, num_words, diagnostic);
 }
 
+struct spvtools::ChunkedBinaryParser::Impl {
+  Impl(const spv_const_context context, const uint32_t* words_arg,
+       size_t num_words_arg)
+      : silent_context(*context), words(words_arg), num_words(num_words_arg) {
+    // Failures are reported by the serial parse the caller falls back to.
+    silent_context.consumer = nullptr;
+  }
+
+  spv_context_t silent_context;
+  const uint32_t* words;
+  size_t num_words;
+  std::vector<size_t> chunk_begins;
+  std::unique_ptr<Parser> prefix;
+  // The result Ids defined by each chunk, filled in as chunks are parsed.
+  std::vector<std::vector<uint32_t>> defined_ids;
+};
+
+spvtools::ChunkedBinaryParser::ChunkedBinaryParser(
+    const spv_const_context context, const uint32_t* words, size_t num_words)
+    : impl_(new Impl(context, words, num_words)) {}
+
+spvtools::ChunkedBinaryParser::~ChunkedBinaryParser() = default;
+
+bool spvtools::ChunkedBinaryParser::Split(size_t max_chunks) {
+  const uint32_t* words = impl_->words;
+  const size_t num_words = impl_->num_words;
+  impl_->chunk_begins.clear();
+  if (!words || num_words < SPV_INDEX_INSTRUCTION) return false;
+
+  spv_const_binary_t binary{words, num_words};
+  spv_endianness_t endian;
+  if (spvBinaryEndianness(&binary, &endian)) return false;
+
+  std::vector<size_t> functions;
+  size_t index = SPV_INDEX_INSTRUCTION;
+  while (index < num_words) {
+    uint16_t word_count = 0;
+    uint16_t opcode = 0;
+    spvOpcodeSplit(spvFixWord(words[index], endian), &word_count, &opcode);
+    if (word_count == 0) return false;
+    if (opcode == SpvOpFunction) functions.push_back(index);
+    index += word_count;
+  }
+  if (index != num_words || functions.empty()) return false;
+
+  // Start a new chunk at the first function past each multiple of the target
+  // size, so that chunks hold whole functions.
+  const size_t target =
+      std::max<size_t>(1, (num_words - functions[0]) / std::max<size_t>(
+                                                          1, max_chunks));
+  for (const size_t function : functions) {
+    if (impl_->chunk_begins.empty() ||
+        (function - impl_->chunk_begins.back() >= target &&
+         impl_->chunk_begins.size() < max_chunks)) {
+      impl_->chunk_begins.push_back(function);
+    }
+  }
+  impl_->defined_ids.assign(impl_->chunk_begins.size(), {});
+  return true;
+}
+
+size_t spvtools::ChunkedBinaryParser::prefix_end() const {
+  assert(!impl_->chunk_begins.empty());
+  return impl_->chunk_begins.front();
+}
+
+size_t spvtools::ChunkedBinaryParser::num_chunks() const {
+  return impl_->chunk_begins.size();
+}
+
+size_t spvtools::ChunkedBinaryParser::chunk_begin(size_t chunk) const {
+  return impl_->chunk_begins[chunk];
+}
+
+spv_result_t spvtools::ChunkedBinaryParser::ParsePrefix(
+    void* user_data, spv_parsed_header_fn_t parsed_header,
+    spv_parsed_instruction_fn_t parsed_instruction) {
+  if (impl_->chunk_begins.empty()) return SPV_ERROR_INVALID_BINARY;
+  impl_->prefix.reset(new Parser(&impl_->silent_context, user_data,
+                                 parsed_header, parsed_instruction));
+  return impl_->prefix->parsePrefix(impl_->words, impl_->num_words,
+                                    prefix_end());
+}
+
+spv_result_t spvtools::ChunkedBinaryParser::ParseChunk(
+    size_t chunk, void* user_data,
+    spv_parsed_instruction_fn_t parsed_instruction) {
+  assert(impl_->prefix && chunk < num_chunks());
+  const size_t end = chunk + 1 < num_chunks() ? chunk_begin(chunk + 1)
+                                              : impl_->num_words;
+  Parser parser(&impl_->silent_context, user_data, nullptr,
+                parsed_instruction);
+  if (auto error = parser.parseRange(*impl_->prefix, chunk_begin(chunk), end))
+    return error;
+  parser.definedIds(&impl_->defined_ids[chunk]);
+  return SPV_SUCCESS;
+}
+
+bool spvtools::ChunkedBinaryParser::ChunksDefineDistinctIds() const {
+  // Each chunk already rejects Ids defined by the prefix or twice within
+  // itself.
+  std::vector<uint32_t> ids;
+  for (const auto& chunk_ids : impl_->defined_ids) {
+    ids.insert(ids.end(), chunk_ids.begin(), chunk_ids.end());
+  }
+  std::sort(ids.begin(), ids.end());
+  return std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+}
+
 // TODO(dneto): This probably belongs in text.cpp since that's the only place
 // that a spv_binary_t value is created.
 void spvBinaryDestroy(spv_binary binary) {
@@ -15,6 +15,9 @@
 #ifndef SOURCE_BINARY_H_
 #define SOURCE_BINARY_H_
 
+#include <memory>
+#include <vector>
+
 #include "source/spirv_definition.h"
 #include "spirv-tools/libspirv.h"
 
@@ -33,4 +36,57 @@ spv_result_t spvBinaryHeaderGet(const spv_const_binary binary,
 // replacement for C11's strnlen_s which might not exist in all environments.
 size_t spv_strnlen_s(const char* str, size_t strsz);
 
+namespace spvtools {
+
+// Parses a module in pieces that can be processed concurrently.  The header
+// and the instructions before the first OpFunction, the prefix, are parsed
+// first.  The functions are then grouped into chunks of whole functions, and
+// each chunk is parsed by continuing from the state left by the prefix.
+//
+// A chunk is parsed without seeing the chunks before it.  So a module where a
+// function refers to an Id defined in an earlier function, such as an OpSwitch
+// selector, fails to parse in chunks, and so does anything the serial parser
+// would reject.  Callers should treat any failure as a signal to fall back to
+// spvBinaryParse, which also produces the diagnostic.  No diagnostics are
+// issued here.
+class ChunkedBinaryParser {
+ public:
+  ChunkedBinaryParser(const spv_const_context context, const uint32_t* words,
+                      size_t num_words);
+  ~ChunkedBinaryParser();
+
+  // Finds the prefix and groups the functions into at most max_chunks chunks
+  // of similar size, by walking the instruction word counts.  Returns false
+  // if the module has no functions or its word counts do not add up.
+  bool Split(size_t max_chunks);
+
+  // The word index at which the prefix ends and the first chunk begins.
+  size_t prefix_end() const;
+  // The number of chunks found by Split.
+  size_t num_chunks() const;
+  // The word index of the first instruction of the given chunk.
+  size_t chunk_begin(size_t chunk) const;
+
+  // Parses the header and the prefix, issuing callbacks with user_data.
+  spv_result_t ParsePrefix(void* user_data,
+                           spv_parsed_header_fn_t parsed_header,
+                           spv_parsed_instruction_fn_t parsed_instruction);
+
+  // Parses the given chunk, issuing instruction callbacks with user_data.
+  // Once ParsePrefix has succeeded, distinct chunks can be parsed
+  // concurrently.
+  spv_result_t ParseChunk(size_t chunk, void* user_data,
+                          spv_parsed_instruction_fn_t parsed_instruction);
+
+  // Returns true if no result Id is defined by more than one chunk.  A serial
+  // parse would reject such a module.  Call after every chunk has parsed.
+  bool ChunksDefineDistinctIds() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace spvtools
+
 #endif  // SOURCE_BINARY_H_
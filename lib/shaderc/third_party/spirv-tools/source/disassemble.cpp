@@ -18,12 +18,17 @@
 // to text.
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
-#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "source/assembly_grammar.h"
 #include "source/binary.h"
@@ -44,10 +49,16 @@ namespace {
 
 // A Disassembler instance converts a SPIR-V binary to its assembly
 // representation.
+//
+// The text is formatted directly into a growable character buffer.  When
+// printing, the buffer is flushed to the standard output stream after every
+// instruction, and before every colour change so that console colours stay in
+// step with the text.
 class Disassembler {
  public:
+  // If |friendly_names| is null, Ids are named by their decimal value.
   Disassembler(const spvtools::AssemblyGrammar& grammar, uint32_t options,
-               spvtools::NameMapper name_mapper)
+               const spvtools::FriendlyNameMapper* friendly_names)
       : grammar_(grammar),
         print_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_PRINT, options)),
         color_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_COLOR, options)),
@@ -56,13 +67,13 @@ class Disassembler {
                     : 0),
         comment_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_COMMENT, options)),
         text_(),
-        out_(print_ ? out_stream() : out_stream(text_)),
-        stream_(out_.get()),
         header_(!spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER, options)),
         show_byte_offset_(spvIsInBitfield(
             SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET, options)),
         byte_offset_(0),
-        name_mapper_(std::move(name_mapper)) {}
+        friendly_names_(friendly_names) {
+    if (friendly_names_) id_names_ = friendly_names_->GetNameTable();
+  }
 
   // Emits the assembly header for the module, and sets up internal state
   // so subsequent callbacks can handle the cases where the entire module
@@ -77,11 +88,46 @@ class Disassembler {
   // Returns SPV_SUCCESS on success.
   spv_result_t SaveTextResult(spv_text* text_result) const;
 
+  // If not printing, moves the accumulated text into |text|.
+  void TakeText(std::string* text) {
+    if (line_offsets_ && line_offsets_->back() == text_.size()) {
+      // Nothing follows the last line break.
+      line_offsets_->pop_back();
+    }
+    text->swap(text_);
+  }
+
+  // Records the offset into the text at which each line starts in
+  // |line_offsets|, which must outlive this object.  Must be called before any
+  // text is emitted.  Ignored when printing.
+  void RecordLineOffsets(std::vector<size_t>* line_offsets) {
+    assert(text_.empty());
+    if (print_) return;
+    line_offsets_ = line_offsets;
+    line_offsets_->assign(1, 0);
+  }
+
+  // Prepares to disassemble a run of instructions that follows the ones
+  // handled by |prefix|, starting at the given byte offset in the binary.
+  void ContinueFrom(const Disassembler& prefix, size_t byte_offset) {
+    endian_ = prefix.endian_;
+    byte_offset_ = byte_offset;
+    inserted_decoration_space_ = prefix.inserted_decoration_space_;
+    inserted_debug_space_ = prefix.inserted_debug_space_;
+    inserted_type_space_ = prefix.inserted_type_space_;
+  }
+
+  // Returns true if the section comments this emits once per module are in
+  // the same state as in |other|.
+  bool InsertedSameSpaces(const Disassembler& other) const {
+    return inserted_decoration_space_ == other.inserted_decoration_space_ &&
+           inserted_debug_space_ == other.inserted_debug_space_ &&
+           inserted_type_space_ == other.inserted_type_space_;
+  }
+
  private:
   enum { kStandardIndent = 15 };
 
-  using out_stream = spvtools::out_stream;
-
   // Emits an operand for the given instruction, where the instruction
   // is at offset words from the start of the binary.
   void EmitOperand(const spv_parsed_instruction_t& inst,
@@ -90,30 +136,109 @@ class Disassembler {
   // Emits a mask expression for the given mask word of the specified type.
   void EmitMaskOperand(const spv_operand_type_t type, const uint32_t word);
 
-  // Resets the output color, if color is turned on.
-  void ResetColor() {
-    if (color_) out_.get() << spvtools::clr::reset{print_};
+  // Emits a literal number operand.
+  void EmitNumber(const spv_parsed_instruction_t& inst,
+                  const spv_parsed_operand_t& operand);
+
+  // Appends text to the buffer.
+  void Emit(const char* str) { text_.append(str); }
+  void Emit(const std::string& str) { text_.append(str); }
+  void Emit(char c) { text_.push_back(c); }
+  void EmitSpaces(int count) {
+    if (count > 0) text_.append(size_t(count), ' ');
   }
-  // Sets the output to grey, if color is turned on.
-  void SetGrey() {
-    if (color_) out_.get() << spvtools::clr::grey{print_};
+  // Appends the decimal representation of value.
+  void EmitUnsigned(uint64_t value) {
+    char digits[20];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+      *--begin = char('0' + value % 10);
+      value /= 10;
+    } while (value);
+    text_.append(begin, end);
   }
-  // Sets the output to blue, if color is turned on.
-  void SetBlue() {
-    if (color_) out_.get() << spvtools::clr::blue{print_};
+  void EmitSigned(int64_t value) {
+    if (value < 0) {
+      text_.push_back('-');
+      EmitUnsigned(uint64_t(0) - uint64_t(value));
+    } else {
+      EmitUnsigned(uint64_t(value));
+    }
   }
-  // Sets the output to yellow, if color is turned on.
-  void SetYellow() {
-    if (color_) out_.get() << spvtools::clr::yellow{print_};
+  // Appends the lowercase hex representation of value, zero padded to at
+  // least |width| digits.
+  void EmitHex(uint64_t value, int width) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    char digits[16];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+      *--begin = kHexDigits[value & 0xf];
+      value >>= 4;
+    } while (value);
+    EmitPadding(width - int(end - begin), '0');
+    text_.append(begin, end);
   }
-  // Sets the output to red, if color is turned on.
-  void SetRed() {
-    if (color_) out_.get() << spvtools::clr::red{print_};
+  void EmitPadding(int count, char c) {
+    if (count > 0) text_.append(size_t(count), c);
   }
-  // Sets the output to green, if color is turned on.
-  void SetGreen() {
-    if (color_) out_.get() << spvtools::clr::green{print_};
+  // Ends the current line.
+  void EmitNewLine() {
+    text_.push_back('\n');
+    if (line_offsets_) line_offsets_->push_back(text_.size());
+  }
+  // Appends the name of the given Id, without the leading '%'.
+  void EmitIdName(uint32_t id) {
+    if (!friendly_names_) {
+      EmitUnsigned(id);
+    } else if (id < id_names_.size() && id_names_[id]) {
+      text_.append(*id_names_[id]);
+    } else {
+      text_.append(friendly_names_->NameForId(id));
+    }
+  }
+  // Returns the length of the name EmitIdName would emit.
+  size_t IdNameLength(uint32_t id) const {
+    if (!friendly_names_) {
+      size_t length = 1;
+      for (; id >= 10; id /= 10) ++length;
+      return length;
+    }
+    if (id < id_names_.size() && id_names_[id]) return id_names_[id]->size();
+    return friendly_names_->NameForId(id).size();
+  }
+
+  // Writes the buffered text to the standard output stream, if printing.
+  void Flush() {
+    if (print_ && !text_.empty()) {
+      std::cout.write(text_.data(), std::streamsize(text_.size()));
+      text_.clear();
+    }
+  }
+
+  // Switches the output colour, if color is turned on.  When printing, the
+  // colour may be a console state change rather than an escape sequence, so
+  // the pending text must go out first.
+  template <typename Color>
+  void SetColor() {
+    if (color_) {
+      Flush();
+      text_.append(static_cast<const char*>(Color{print_}));
+    }
   }
+  // Resets the output color, if color is turned on.
+  void ResetColor() { SetColor<spvtools::clr::reset>(); }
+  // Sets the output to grey, if color is turned on.
+  void SetGrey() { SetColor<spvtools::clr::grey>(); }
+  // Sets the output to blue, if color is turned on.
+  void SetBlue() { SetColor<spvtools::clr::blue>(); }
+  // Sets the output to yellow, if color is turned on.
+  void SetYellow() { SetColor<spvtools::clr::yellow>(); }
+  // Sets the output to red, if color is turned on.
+  void SetRed() { SetColor<spvtools::clr::red>(); }
+  // Sets the output to green, if color is turned on.
+  void SetGreen() { SetColor<spvtools::clr::green>(); }
 
   const spvtools::AssemblyGrammar& grammar_;
   const bool print_;  // Should we also print to the standard output stream?
@@ -121,13 +246,16 @@ class Disassembler {
   const int indent_;  // How much to indent. 0 means don't indent
   const int comment_;        // Should we comment the source
   spv_endianness_t endian_;  // The detected endianness of the binary.
-  std::stringstream text_;   // Captures the text, if not printing.
-  out_stream out_;  // The Output stream.  Either to text_ or standard output.
-  std::ostream& stream_;  // The output std::stream.
+  std::string text_;  // The text, or when printing, the unflushed text.
+  std::stringstream float_text_;  // Scratch space for formatting floats.
+  std::vector<size_t>* line_offsets_ = nullptr;  // Where each line starts.
   const bool header_;     // Should we output header as the leading comment?
   const bool show_byte_offset_;  // Should we print byte offset, in hex?
   size_t byte_offset_;           // The number of bytes processed so far.
-  spvtools::NameMapper name_mapper_;
+  // Source of friendly Id names, or null to name Ids by number.
+  const spvtools::FriendlyNameMapper* friendly_names_;
+  // Friendly names indexed by Id, null where the mapper must be asked.
+  std::vector<const std::string*> id_names_;
   bool inserted_decoration_space_ = false;
   bool inserted_debug_space_ = false;
   bool inserted_type_space_ = false;
@@ -141,23 +269,37 @@ spv_result_t Disassembler::HandleHeader(spv_endianness_t endian,
   if (header_) {
     const char* generator_tool =
         spvGeneratorStr(SPV_GENERATOR_TOOL_PART(generator));
-    stream_ << "; SPIR-V\n"
-            << "; Version: " << SPV_SPIRV_VERSION_MAJOR_PART(version) << "."
-            << SPV_SPIRV_VERSION_MINOR_PART(version) << "\n"
-            << "; Generator: " << generator_tool;
+    Emit("; SPIR-V");
+    EmitNewLine();
+    Emit("; Version: ");
+    EmitUnsigned(SPV_SPIRV_VERSION_MAJOR_PART(version));
+    Emit('.');
+    EmitUnsigned(SPV_SPIRV_VERSION_MINOR_PART(version));
+    EmitNewLine();
+    Emit("; Generator: ");
+    Emit(generator_tool);
     // For unknown tools, print the numeric tool value.
     if (0 == strcmp("Unknown", generator_tool)) {
-      stream_ << "(" << SPV_GENERATOR_TOOL_PART(generator) << ")";
+      Emit('(');
+      EmitUnsigned(SPV_GENERATOR_TOOL_PART(generator));
+      Emit(')');
     }
     // Print the miscellaneous part of the generator word on the same
     // line as the tool name.
-    stream_ << "; " << SPV_GENERATOR_MISC_PART(generator) << "\n"
-            << "; Bound: " << id_bound << "\n"
-            << "; Schema: " << schema << "\n";
+    Emit("; ");
+    EmitUnsigned(SPV_GENERATOR_MISC_PART(generator));
+    EmitNewLine();
+    Emit("; Bound: ");
+    EmitUnsigned(id_bound);
+    EmitNewLine();
+    Emit("; Schema: ");
+    EmitUnsigned(schema);
+    EmitNewLine();
   }
 
   byte_offset_ = SPV_INDEX_INSTRUCTION * sizeof(uint32_t);
 
+  Flush();
   return SPV_SUCCESS;
 }
 
@@ -165,72 +307,79 @@ spv_result_t Disassembler::HandleInstruction(
     const spv_parsed_instruction_t& inst) {
   auto opcode = static_cast<SpvOp>(inst.opcode);
   if (comment_ && opcode == SpvOpFunction) {
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Function " << name_mapper_(inst.result_id) << std::endl;
+    EmitNewLine();
+    EmitSpaces(indent_);
+    Emit("; Function ");
+    EmitIdName(inst.result_id);
+    EmitNewLine();
   }
   if (comment_ && !inserted_decoration_space_ &&
       spvOpcodeIsDecoration(opcode)) {
     inserted_decoration_space_ = true;
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Annotations" << std::endl;
+    EmitNewLine();
+    EmitSpaces(indent_);
+    Emit("; Annotations");
+    EmitNewLine();
   }
   if (comment_ && !inserted_debug_space_ && spvOpcodeIsDebug(opcode)) {
     inserted_debug_space_ = true;
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Debug Information" << std::endl;
+    EmitNewLine();
+    EmitSpaces(indent_);
+    Emit("; Debug Information");
+    EmitNewLine();
   }
   if (comment_ && !inserted_type_space_ && spvOpcodeGeneratesType(opcode)) {
     inserted_type_space_ = true;
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Types, variables and constants" << std::endl;
+    EmitNewLine();
+    EmitSpaces(indent_);
+    Emit("; Types, variables and constants");
+    EmitNewLine();
   }
 
   if (inst.result_id) {
     SetBlue();
-    const std::string id_name = name_mapper_(inst.result_id);
-    if (indent_)
-      stream_ << std::setw(std::max(0, indent_ - 3 - int(id_name.size())));
-    stream_ << "%" << id_name;
+    // Right align the result Id so that the opcodes line up.  The '%' is
+    // part of the aligned field.
+    if (indent_) {
+      EmitSpaces(indent_ - 4 - int(IdNameLength(inst.result_id)));
+    }
+    Emit('%');
+    EmitIdName(inst.result_id);
     ResetColor();
-    stream_ << " = ";
+    Emit(" = ");
   } else {
-    stream_ << std::string(indent_, ' ');
+    EmitSpaces(indent_);
   }
 
-  stream_ << "Op" << spvOpcodeString(opcode);
+  Emit("Op");
+  Emit(spvOpcodeString(opcode));
 
   for (uint16_t i = 0; i < inst.num_operands; i++) {
     const spv_operand_type_t type = inst.operands[i].type;
     assert(type != SPV_OPERAND_TYPE_NONE);
     if (type == SPV_OPERAND_TYPE_RESULT_ID) continue;
-    stream_ << " ";
+    Emit(' ');
     EmitOperand(inst, i);
   }
 
   if (comment_ && opcode == SpvOpName) {
     const spv_parsed_operand_t& operand = inst.operands[0];
     const uint32_t word = inst.words[operand.offset];
-    stream_ << "  ; id %" << word;
+    Emit("  ; id %");
+    EmitUnsigned(word);
   }
 
   if (show_byte_offset_) {
     SetGrey();
-    auto saved_flags = stream_.flags();
-    auto saved_fill = stream_.fill();
-    stream_ << " ; 0x" << std::setw(8) << std::hex << std::setfill('0')
-            << byte_offset_;
-    stream_.flags(saved_flags);
-    stream_.fill(saved_fill);
+    Emit(" ; 0x");
+    EmitHex(byte_offset_, 8);
     ResetColor();
   }
 
   byte_offset_ += inst.num_words * sizeof(uint32_t);
 
-  stream_ << "\n";
+  EmitNewLine();
+  Flush();
   return SPV_SUCCESS;
 }
 
@@ -243,27 +392,29 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
     case SPV_OPERAND_TYPE_RESULT_ID:
       assert(false && "<result-id> is not supposed to be handled here");
       SetBlue();
-      stream_ << "%" << name_mapper_(word);
+      Emit('%');
+      EmitIdName(word);
       break;
     case SPV_OPERAND_TYPE_ID:
     case SPV_OPERAND_TYPE_TYPE_ID:
     case SPV_OPERAND_TYPE_SCOPE_ID:
     case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       SetYellow();
-      stream_ << "%" << name_mapper_(word);
+      Emit('%');
+      EmitIdName(word);
       break;
     case SPV_OPERAND_TYPE_EXTENSION_INSTRUCTION_NUMBER: {
       spv_ext_inst_desc ext_inst;
       SetRed();
       if (grammar_.lookupExtInst(inst.ext_inst_type, word, &ext_inst) ==
           SPV_SUCCESS) {
-        stream_ << ext_inst->name;
+        Emit(ext_inst->name);
       } else {
         if (!spvExtInstIsNonSemantic(inst.ext_inst_type)) {
           assert(false && "should have caught this earlier");
         } else {
           // for non-semantic instruction sets we can just print the number
-          stream_ << word;
+          EmitUnsigned(word);
         }
       }
     } break;
@@ -272,27 +423,31 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
       if (grammar_.lookupOpcode(SpvOp(word), &opcode_desc))
         assert(false && "should have caught this earlier");
       SetRed();
-      stream_ << opcode_desc->name;
+      Emit(opcode_desc->name);
     } break;
     case SPV_OPERAND_TYPE_LITERAL_INTEGER:
     case SPV_OPERAND_TYPE_TYPED_LITERAL_NUMBER: {
       SetRed();
-      spvtools::EmitNumericLiteral(&stream_, inst, operand);
+      EmitNumber(inst, operand);
       ResetColor();
     } break;
     case SPV_OPERAND_TYPE_LITERAL_STRING: {
-      stream_ << "\"";
+      Emit('"');
       SetGreen();
       // Strings are always little-endian, and null-terminated.
       // Write out the characters, escaping as needed, and without copying
       // the entire string.
       auto c_str = reinterpret_cast<const char*>(inst.words + operand.offset);
       for (auto p = c_str; *p; ++p) {
-        if (*p == '"' || *p == '\\') stream_ << '\\';
-        stream_ << *p;
+        if (*p == '"' || *p == '\\') Emit('\\');
+        if (*p == '\n') {
+          EmitNewLine();
+        } else {
+          Emit(*p);
+        }
       }
       ResetColor();
-      stream_ << '"';
+      Emit('"');
     } break;
     case SPV_OPERAND_TYPE_CAPABILITY:
     case SPV_OPERAND_TYPE_SOURCE_LANGUAGE:
@@ -332,7 +487,7 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
       spv_operand_desc entry;
       if (grammar_.lookupOperand(operand.type, word, &entry))
         assert(false && "should have caught this earlier");
-      stream_ << entry->name;
+      Emit(entry->name);
     } break;
     case SPV_OPERAND_TYPE_FP_FAST_MATH_MODE:
     case SPV_OPERAND_TYPE_FUNCTION_CONTROL:
@@ -363,8 +518,8 @@ void Disassembler::EmitMaskOperand(const spv_operand_type_t type,
       spv_operand_desc entry;
       if (grammar_.lookupOperand(type, mask, &entry))
         assert(false && "should have caught this earlier");
-      if (num_emitted) stream_ << "|";
-      stream_ << entry->name;
+      if (num_emitted) Emit('|');
+      Emit(entry->name);
       num_emitted++;
     }
   }
@@ -373,25 +528,63 @@ void Disassembler::EmitMaskOperand(const spv_operand_type_t type,
     // of the 0 value. In many cases, that's "None".
     spv_operand_desc entry;
     if (SPV_SUCCESS == grammar_.lookupOperand(type, 0, &entry))
-      stream_ << entry->name;
+      Emit(entry->name);
   }
 }
 
-spv_result_t Disassembler::SaveTextResult(spv_text* text_result) const {
-  if (!print_) {
-    size_t length = text_.str().size();
-    char* str = new char[length + 1];
-    if (!str) return SPV_ERROR_OUT_OF_MEMORY;
-    strncpy(str, text_.str().c_str(), length + 1);
-    spv_text text = new spv_text_t();
-    if (!text) {
-      delete[] str;
-      return SPV_ERROR_OUT_OF_MEMORY;
-    }
-    text->str = str;
-    text->length = length;
-    *text_result = text;
+void Disassembler::EmitNumber(const spv_parsed_instruction_t& inst,
+                              const spv_parsed_operand_t& operand) {
+  // Integers are formatted in place.  Floats keep the stream based formatting
+  // shared with the rest of the tools.
+  if (operand.number_kind == SPV_NUMBER_FLOATING) {
+    float_text_.str(std::string());
+    spvtools::EmitNumericLiteral(&float_text_, inst, operand);
+    Emit(float_text_.str());
+    return;
+  }
+  if (operand.num_words < 1 || operand.num_words > 2) return;
+
+  // Multi-word numbers are presented with lower order words first.
+  const uint32_t word = inst.words[operand.offset];
+  const uint64_t bits =
+      operand.num_words == 1
+          ? word
+          : uint64_t(word) | (uint64_t(inst.words[operand.offset + 1]) << 32);
+  switch (operand.number_kind) {
+    case SPV_NUMBER_SIGNED_INT:
+      if (operand.num_words == 1) {
+        EmitSigned(int32_t(word));
+      } else {
+        EmitSigned(int64_t(bits));
+      }
+      break;
+    case SPV_NUMBER_UNSIGNED_INT:
+      EmitUnsigned(bits);
+      break;
+    default:
+      break;
+  }
+}
+
+// Copies |source| into a new spv_text.
+spv_result_t MakeText(const std::string& source, spv_text* text_result) {
+  size_t length = source.size();
+  char* str = new char[length + 1];
+  if (!str) return SPV_ERROR_OUT_OF_MEMORY;
+  memcpy(str, source.c_str(), length + 1);
+  spv_text text = new spv_text_t();
+  if (!text) {
+    delete[] str;
+    return SPV_ERROR_OUT_OF_MEMORY;
   }
+  text->str = str;
+  text->length = length;
+  *text_result = text;
+  return SPV_SUCCESS;
+}
+
+spv_result_t Disassembler::SaveTextResult(spv_text* text_result) const {
+  if (!print_) return MakeText(text_, text_result);
   return SPV_SUCCESS;
 }
 
@@ -412,6 +605,125 @@ spv_result_t DisassembleInstruction(
   return disassembler->HandleInstruction(*parsed_instruction);
 }
 
+// Modules smaller than this, in words, are not worth splitting across threads.
+const size_t kMinParallelWordCount = 1 << 16;
+// The number of chunks per thread.  More chunks even out the load when
+// function sizes vary, at a small cost per chunk.
+const size_t kChunksPerThread = 4;
+
+// A run of whole functions disassembled on its own.
+struct DisassemblyChunk {
+  std::unique_ptr<Disassembler> disassembler;
+  // The names of a friendly disassembly, which only cover the module prefix.
+  const spvtools::FriendlyNameMapper* friendly_names;
+  std::string text;
+  std::vector<size_t> line_offsets;
+  spv_result_t result;
+};
+
+spv_result_t DisassembleChunkInstruction(
+    void* user_data, const spv_parsed_instruction_t* parsed_instruction) {
+  assert(user_data);
+  auto chunk = static_cast<DisassemblyChunk*>(user_data);
+  // Fall back to a serial disassembly if the names would have depended on
+  // what came before this chunk.
+  if (chunk->friendly_names &&
+      !chunk->friendly_names->IgnoresInstruction(*parsed_instruction)) {
+    return SPV_REQUESTED_TERMINATION;
+  }
+  return chunk->disassembler->HandleInstruction(*parsed_instruction);
+}
+
+// Disassembles the module with its functions split into chunks that are
+// formatted on worker threads, then joined in order.  Returns false if the
+// module should be disassembled serially instead: it is too small, fails to
+// parse in chunks, or a chunk would come out differently from a serial
+// disassembly.  The serial disassembly also reports any error.
+bool DisassembleInParallel(const spv_const_context context,
+                           const spvtools::AssemblyGrammar& grammar,
+                           const uint32_t* code, const size_t word_count,
+                           const uint32_t options, std::string* text,
+                           std::vector<size_t>* line_offsets) {
+  const size_t num_threads = std::thread::hardware_concurrency();
+  if (num_threads < 2 || word_count < kMinParallelWordCount) return false;
+
+  spvtools::ChunkedBinaryParser parser(context, code, word_count);
+  if (!parser.Split(num_threads * kChunksPerThread) ||
+      parser.num_chunks() < 2) {
+    return false;
+  }
+
+  // Names for the chunks come from the prefix alone, where valid modules
+  // declare everything with a friendly name.
+  std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
+  if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
+    friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
+        context, code, parser.prefix_end());
+  }
+
+  std::vector<size_t> prefix_offsets;
+  Disassembler prefix(grammar, options, friendly_mapper.get());
+  if (line_offsets) prefix.RecordLineOffsets(&prefix_offsets);
+  if (parser.ParsePrefix(&prefix, DisassembleHeader, DisassembleInstruction))
+    return false;
+
+  std::vector<DisassemblyChunk> chunks(parser.num_chunks());
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    chunks[i].disassembler = spvtools::MakeUnique<Disassembler>(
+        grammar, options, friendly_mapper.get());
+    chunks[i].disassembler->ContinueFrom(
+        prefix, parser.chunk_begin(i) * sizeof(uint32_t));
+    if (line_offsets) {
+      chunks[i].disassembler->RecordLineOffsets(&chunks[i].line_offsets);
+    }
+    chunks[i].friendly_names = friendly_mapper.get();
+    chunks[i].result = SPV_SUCCESS;
+  }
+
+  std::atomic<size_t> next_chunk(0);
+  auto work = [&parser, &chunks, &next_chunk]() {
+    for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++) {
+      DisassemblyChunk& chunk = chunks[i];
+      chunk.result =
+          parser.ParseChunk(i, &chunk, DisassembleChunkInstruction);
+      if (chunk.result == SPV_SUCCESS) {
+        chunk.disassembler->TakeText(&chunk.text);
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min(num_threads, chunks.size()); ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) worker.join();
+
+  for (const auto& chunk : chunks) {
+    if (chunk.result != SPV_SUCCESS ||
+        !chunk.disassembler->InsertedSameSpaces(prefix)) {
+      return false;
+    }
+  }
+  if (!parser.ChunksDefineDistinctIds()) return false;
+
+  std::string joined;
+  prefix.TakeText(&joined);
+  size_t length = joined.size();
+  for (const auto& chunk : chunks) length += chunk.text.size();
+  joined.reserve(length);
+  for (const auto& chunk : chunks) {
+    const size_t base = joined.size();
+    for (const size_t offset : chunk.line_offsets) {
+      prefix_offsets.push_back(base + offset);
+    }
+    joined.append(chunk.text);
+  }
+
+  text->swap(joined);
+  if (line_offsets) line_offsets->swap(prefix_offsets);
+  return true;
+}
+
 // Simple wrapper class to provide extra data necessary for targeted
 // instruction disassembly.
 class WrappedDisassembler {
@@ -473,17 +785,25 @@ spv_result_t spvBinaryToText(const spv_const_context context,
   const spvtools::AssemblyGrammar grammar(&hijack_context);
   if (!grammar.isValid()) return SPV_ERROR_INVALID_TABLE;
 
+  if ((options & SPV_BINARY_TO_TEXT_OPTION_PARALLEL) &&
+      !(options & SPV_BINARY_TO_TEXT_OPTION_PRINT)) {
+    std::string text;
+    if (auto error = spvtools::DisassembleBinary(
+            context, code, wordCount, options, &text, nullptr, pDiagnostic)) {
+      return error;
+    }
+    return MakeText(text, pText);
+  }
+
   // Generate friendly names for Ids if requested.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
-  spvtools::NameMapper name_mapper = spvtools::GetTrivialNameMapper();
   if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
     friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
         &hijack_context, code, wordCount);
-    name_mapper = friendly_mapper->GetNameMapper();
   }
 
   // Now disassemble!
-  Disassembler disassembler(grammar, options, name_mapper);
+  Disassembler disassembler(grammar, options, friendly_mapper.get());
   if (auto error = spvBinaryParse(&hijack_context, &disassembler, code,
                                   wordCount, DisassembleHeader,
                                   DisassembleInstruction, pDiagnostic)) {
@@ -493,6 +813,52 @@ spv_result_t spvBinaryToText(const spv_const_context context,
   return disassembler.SaveTextResult(pText);
 }
 
+spv_result_t spvtools::DisassembleBinary(const spv_const_context context,
+                                         const uint32_t* code,
+                                         const size_t word_count,
+                                         const uint32_t options,
+                                         std::string* text,
+                                         std::vector<size_t>* line_offsets,
+                                         spv_diagnostic* diagnostic) {
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+
+  const spvtools::AssemblyGrammar grammar(&hijack_context);
+  if (!grammar.isValid()) return SPV_ERROR_INVALID_TABLE;
+
+  if ((options & SPV_BINARY_TO_TEXT_OPTION_PARALLEL) &&
+      !(options & SPV_BINARY_TO_TEXT_OPTION_PRINT) &&
+      DisassembleInParallel(&hijack_context, grammar, code, word_count,
+                            options, text, line_offsets)) {
+    return SPV_SUCCESS;
+  }
+
+  // Generate friendly names for Ids if requested.
+  std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
+  if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
+    friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
+        &hijack_context, code, word_count);
+  }
+
+  // Collect the line offsets separately so that they are left untouched on
+  // failure, like the text.
+  std::vector<size_t> offsets;
+  Disassembler disassembler(grammar, options, friendly_mapper.get());
+  if (line_offsets) disassembler.RecordLineOffsets(&offsets);
+  if (auto error = spvBinaryParse(&hijack_context, &disassembler, code,
+                                  word_count, DisassembleHeader,
+                                  DisassembleInstruction, diagnostic)) {
+    return error;
+  }
+
+  disassembler.TakeText(text);
+  if (line_offsets) line_offsets->swap(offsets);
+  return SPV_SUCCESS;
+}
+
 std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
                                                  const uint32_t* instCode,
                                                  const size_t instWordCount,
@@ -508,15 +874,13 @@ std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
 
   // Generate friendly names for Ids if requested.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
-  spvtools::NameMapper name_mapper = spvtools::GetTrivialNameMapper();
   if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
     friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
         context, code, wordCount);
-    name_mapper = friendly_mapper->GetNameMapper();
   }
 
   // Now disassemble!
-  Disassembler disassembler(grammar, options, name_mapper);
+  Disassembler disassembler(grammar, options, friendly_mapper.get());
   WrappedDisassembler wrapped(&disassembler, instCode, instWordCount);
   spvBinaryParse(context, &wrapped, code, wordCount, DisassembleTargetHeader,
                  DisassembleTargetInstruction, nullptr);
@@ -16,11 +16,22 @@
 #define SOURCE_DISASSEMBLE_H_
 
 #include <string>
+#include <vector>
 
 #include "spirv-tools/libspirv.h"
 
 namespace spvtools {
 
+// Disassembles the given module like spvBinaryToText, but into |text|.  If
+// |line_offsets| is not null, it receives the offset into |text| at which each
+// line starts.  Neither is modified on failure.  Options that print to the
+// standard output stream leave both empty.
+spv_result_t DisassembleBinary(const spv_const_context context,
+                               const uint32_t* code, const size_t word_count,
+                               const uint32_t options, std::string* text,
+                               std::vector<size_t>* line_offsets,
+                               spv_diagnostic* diagnostic);
+
 // Decodes the given SPIR-V instruction binary representation to its assembly
 // text. The context is inferred from the provided module binary. The options
 // parameter is a bit field of spv_binary_to_text_options_t. Decoded text will
@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "source/disassemble.h"
 #include "source/table.h"
 
 namespace spvtools {
@@ -96,13 +97,26 @@ bool SpirvTools::Disassemble(const std::vector<uint32_t>& binary,
 
 bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
                              std::string* text, uint32_t options) const {
-  spv_text spvtext = nullptr;
-  spv_result_t status = spvBinaryToText(impl_->context, binary, binary_size,
-                                        options, &spvtext, nullptr);
-  if (status == SPV_SUCCESS) {
-    text->assign(spvtext->str, spvtext->str + spvtext->length);
-  }
-  spvTextDestroy(spvtext);
+  return Disassemble(binary, binary_size, text, nullptr, options);
+}
+
+bool SpirvTools::Disassemble(const std::vector<uint32_t>& binary,
+                             std::string* text,
+                             std::vector<size_t>* line_offsets,
+                             uint32_t options) const {
+  return Disassemble(binary.data(), binary.size(), text, line_offsets,
+                     options);
+}
+
+bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
+                             std::string* text,
+                             std::vector<size_t>* line_offsets,
+                             uint32_t options) const {
+  std::string disassembly;
+  const spv_result_t status =
+      DisassembleBinary(impl_->context, binary, binary_size, options,
+                        &disassembly, line_offsets, nullptr);
+  if (status == SPV_SUCCESS) text->swap(disassembly);
   return status == SPV_SUCCESS;
 }
 
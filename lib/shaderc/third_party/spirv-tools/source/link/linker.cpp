@@ -15,11 +15,14 @@
 #include "spirv-tools/linker.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -27,6 +30,8 @@
 
 #include "source/assembly_grammar.h"
 #include "source/diagnostic.h"
+#include "source/opcode.h"
+#include "source/operand.h"
 #include "source/opt/build_module.h"
 #include "source/opt/compact_ids_pass.h"
 #include "source/opt/decoration_manager.h"
@@ -70,16 +75,45 @@ struct LinkageEntry {
 };
 using LinkageTable = std::vector<LinkageEntry>;
 
+// Maps the result id of each global that duplicates an earlier one onto the
+// result id of that earlier global.
+using IdReplacements = std::unordered_map<uint32_t, uint32_t>;
+
+// Hashes a sequence of words, such as the structural key of a global.
+struct WordsHash {
+  size_t operator()(const std::vector<uint32_t>& words) const {
+    size_t hash = words.size();
+    for (const uint32_t word : words)
+      hash ^= word + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+  }
+};
+
+// A message reported while parsing a module on a worker thread, kept until it
+// can be passed on in module order.
+struct HeldMessage {
+  spv_message_level_t level;
+  std::string source;
+  spv_position_t position;
+  std::string message;
+};
+
+// Calls |process| with each index in [0, |count|). If |in_parallel| is true,
+// the indices are spread over up to one thread per hardware thread.
+void ForEachModule(size_t count, bool in_parallel,
+                   const std::function<void(size_t)>& process);
+
 // Shifts the IDs used in each binary of |modules| so that they occupy a
 // disjoint range from the other binaries, and compute the new ID bound which
-// is returned in |max_id_bound|.
+// is returned in |max_id_bound|. If |in_parallel| is true, the modules are
+// shifted on several threads.
 //
 // Both |modules| and |max_id_bound| should not be null, and |modules| should
 // not be empty either. Furthermore |modules| should not contain any null
 // pointers.
 spv_result_t ShiftIdsInModules(const MessageConsumer& consumer,
                                std::vector<opt::Module*>* modules,
-                               uint32_t* max_id_bound);
+                               bool in_parallel, uint32_t* max_id_bound);
 
 // Generates the header for the linked module and returns it in |header|.
 //
@@ -93,13 +127,32 @@ spv_result_t GenerateHeader(const MessageConsumer& consumer,
                             const std::vector<opt::Module*>& modules,
                             uint32_t max_id_bound, opt::ModuleHeader* header);
 
+// Finds the extended instruction imports, types and constants of |modules|
+// that duplicate an earlier one, and records them in |replacements|. Types and
+// constants are duplicates when they have the same opcode, the same operands
+// once earlier duplicates are replaced, and the same decorations.
+// Specialization constants are never treated as duplicates.
+//
+// A forward pointer can refer to a type declared further down, so the types
+// of a module using one might only turn out to be duplicates afterwards;
+// |has_forward_pointers| is set if any module has one.
+void FindDuplicateGlobals(const std::vector<Module*>& modules,
+                          IdReplacements* replacements,
+                          bool* has_forward_pointers);
+
 // Merge all the modules from |in_modules| into a single module owned by
 // |linked_context|.
 //
+// If |replacements| is not null, the globals it lists are left out, and uses
+// of them are replaced with the globals they duplicate. Duplicate
+// capabilities and decorations are left out as well, and the functions of
+// the modules are copied on several threads.
+//
 // |linked_context| should not be null.
 spv_result_t MergeModules(const MessageConsumer& consumer,
                           const std::vector<Module*>& in_modules,
                           const AssemblyGrammar& grammar,
+                          const IdReplacements* replacements,
                           IRContext* linked_context);
 
 // Compute all pairs of import and export and return it in |linkings_to_do|.
@@ -147,9 +200,29 @@ spv_result_t RemoveLinkageSpecificInstructions(
 spv_result_t VerifyIds(const MessageConsumer& consumer,
                        opt::IRContext* linked_context);
 
+void ForEachModule(size_t count, bool in_parallel,
+                   const std::function<void(size_t)>& process) {
+  const size_t num_threads =
+      in_parallel ? std::min<size_t>(std::thread::hardware_concurrency(), count)
+                  : 1u;
+  if (num_threads < 2u) {
+    for (size_t i = 0u; i < count; ++i) process(i);
+    return;
+  }
+
+  std::atomic<size_t> next_module(0u);
+  auto work = [count, &process, &next_module]() {
+    for (size_t i = next_module++; i < count; i = next_module++) process(i);
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1u; i < num_threads; ++i) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+}
+
 spv_result_t ShiftIdsInModules(const MessageConsumer& consumer,
                                std::vector<opt::Module*>* modules,
-                               uint32_t* max_id_bound) {
+                               bool in_parallel, uint32_t* max_id_bound) {
   spv_position_t position = {};
 
   if (modules == nullptr)
@@ -162,22 +235,31 @@ spv_result_t ShiftIdsInModules(const MessageConsumer& consumer,
     return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_DATA)
            << "|max_id_bound| of ShiftIdsInModules should not be null.";
 
+  // Each module is shifted by the sum of the bounds of the modules before it,
+  // so the shifts are known before any module is touched.
+  std::vector<uint32_t> shifts(modules->size(), 0u);
   uint32_t id_bound = modules->front()->IdBound() - 1u;
-  for (auto module_iter = modules->begin() + 1; module_iter != modules->end();
-       ++module_iter) {
-    Module* module = *module_iter;
-    module->ForEachInst([&id_bound](Instruction* insn) {
-      insn->ForEachId([&id_bound](uint32_t* id) { *id += id_bound; });
-    });
-    id_bound += module->IdBound() - 1u;
+  for (size_t i = 1u; i < modules->size(); ++i) {
+    shifts[i] = id_bound;
+    id_bound += (*modules)[i]->IdBound() - 1u;
     if (id_bound > 0x3FFFFF)
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_ID)
              << "The limit of IDs, 4194303, was exceeded:"
              << " " << id_bound << " is the current ID bound.";
-
-    // Invalidate the DefUseManager
-    module->context()->InvalidateAnalyses(opt::IRContext::kAnalysisDefUse);
   }
+
+  ForEachModule(modules->size() - 1u, in_parallel,
+                [modules, &shifts](size_t i) {
+                  Module* module = (*modules)[i + 1u];
+                  const uint32_t shift = shifts[i + 1u];
+                  module->ForEachInst([shift](Instruction* insn) {
+                    insn->ForEachId([shift](uint32_t* id) { *id += shift; });
+                  });
+
+                  // Invalidate the DefUseManager
+                  module->context()->InvalidateAnalyses(
+                      opt::IRContext::kAnalysisDefUse);
+                });
   ++id_bound;
   if (id_bound > 0x3FFFFF)
     return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_ID)
@@ -214,9 +296,129 @@ spv_result_t GenerateHeader(const MessageConsumer& consumer,
   return SPV_SUCCESS;
 }
 
+// Returns the id that replaces |id| according to |replacements|.
+uint32_t ReplacedId(const IdReplacements& replacements, uint32_t id) {
+  const auto replacement = replacements.find(id);
+  return replacement == replacements.end() ? id : replacement->second;
+}
+
+// Replaces the ids used by |inst| according to |replacements|.
+void ReplaceIds(const IdReplacements& replacements, Instruction* inst) {
+  inst->ForEachId(
+      [&replacements](uint32_t* id) { *id = ReplacedId(replacements, *id); });
+}
+
+// Appends to |key| the opcode and the operands of |inst|, except for its
+// result id, with ids replaced according to |replacements|.
+void AppendInstructionKey(const Instruction& inst,
+                          const IdReplacements& replacements,
+                          std::vector<uint32_t>* key) {
+  key->push_back(inst.opcode());
+  for (const auto& operand : inst) {
+    if (operand.type == SPV_OPERAND_TYPE_RESULT_ID) continue;
+    key->push_back(static_cast<uint32_t>(operand.words.size()));
+    if (spvIsIdType(operand.type)) {
+      key->push_back(ReplacedId(replacements, operand.words[0]));
+    } else {
+      key->insert(key->end(), operand.words.begin(), operand.words.end());
+    }
+  }
+}
+
+// Collects in |keys|, for each id of |module| decorated only through
+// OpDecorate, OpDecorateString, OpMemberDecorate and OpMemberDecorateString,
+// the words of its decorations without their target, in a canonical order.
+// Ids decorated in any other way are added to |pinned| instead.
+void CollectDecorationKeys(
+    const Module& module,
+    std::unordered_map<uint32_t, std::vector<uint32_t>>* keys,
+    std::unordered_set<uint32_t>* pinned) {
+  std::unordered_map<uint32_t, std::vector<std::vector<uint32_t>>> decorations;
+  for (const auto& inst : module.annotations()) {
+    switch (inst.opcode()) {
+      case SpvOpDecorate:
+      case SpvOpDecorateString:
+      case SpvOpMemberDecorate:
+      case SpvOpMemberDecorateString: {
+        std::vector<uint32_t> words(1u, inst.opcode());
+        for (uint32_t i = 1u; i < inst.NumInOperands(); ++i) {
+          const auto& operand_words = inst.GetInOperand(i).words;
+          words.push_back(static_cast<uint32_t>(operand_words.size()));
+          words.insert(words.end(), operand_words.begin(),
+                       operand_words.end());
+        }
+        decorations[inst.GetSingleWordInOperand(0u)].push_back(
+            std::move(words));
+        break;
+      }
+      case SpvOpDecorateId:
+        pinned->insert(inst.GetSingleWordInOperand(0u));
+        break;
+      case SpvOpGroupDecorate:
+        for (uint32_t i = 1u; i < inst.NumInOperands(); ++i)
+          pinned->insert(inst.GetSingleWordInOperand(i));
+        break;
+      case SpvOpGroupMemberDecorate:
+        for (uint32_t i = 1u; i < inst.NumInOperands(); i += 2u)
+          pinned->insert(inst.GetSingleWordInOperand(i));
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (auto& entry : decorations) {
+    std::sort(entry.second.begin(), entry.second.end());
+    std::vector<uint32_t>& key = (*keys)[entry.first];
+    for (const auto& words : entry.second)
+      key.insert(key.end(), words.begin(), words.end());
+  }
+}
+
+void FindDuplicateGlobals(const std::vector<Module*>& modules,
+                          IdReplacements* replacements,
+                          bool* has_forward_pointers) {
+  std::unordered_map<std::string, uint32_t> ext_inst_imports;
+  std::unordered_map<std::vector<uint32_t>, uint32_t, WordsHash> globals;
+  *has_forward_pointers = false;
+  for (const auto& module : modules) {
+    for (const auto& inst : module->ext_inst_imports()) {
+      const auto res = ext_inst_imports.emplace(
+          reinterpret_cast<const char*>(inst.GetInOperand(0u).words.data()),
+          inst.result_id());
+      if (!res.second) (*replacements)[inst.result_id()] = res.first->second;
+    }
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> decoration_keys;
+    std::unordered_set<uint32_t> pinned;
+    CollectDecorationKeys(*module, &decoration_keys, &pinned);
+
+    std::vector<uint32_t> key;
+    for (const auto& inst : module->types_values()) {
+      const SpvOp opcode = inst.opcode();
+      if (opcode == SpvOpTypeForwardPointer) *has_forward_pointers = true;
+      if (!spvOpcodeGeneratesType(opcode) &&
+          (!spvOpcodeIsConstant(opcode) || spvOpcodeIsSpecConstant(opcode)))
+        continue;
+      const uint32_t id = inst.result_id();
+      if (pinned.count(id)) continue;
+
+      key.clear();
+      AppendInstructionKey(inst, *replacements, &key);
+      const auto decoration_key = decoration_keys.find(id);
+      if (decoration_key != decoration_keys.end())
+        key.insert(key.end(), decoration_key->second.begin(),
+                   decoration_key->second.end());
+      const auto res = globals.emplace(key, id);
+      if (!res.second) (*replacements)[id] = res.first->second;
+    }
+  }
+}
+
 spv_result_t MergeModules(const MessageConsumer& consumer,
                           const std::vector<Module*>& input_modules,
                           const AssemblyGrammar& grammar,
+                          const IdReplacements* replacements,
                           IRContext* linked_context) {
   spv_position_t position = {};
 
@@ -227,20 +429,33 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
 
   if (input_modules.empty()) return SPV_SUCCESS;
 
+  const bool deduplicate = replacements != nullptr;
+  const auto is_replaced = [replacements](uint32_t id) {
+    return replacements != nullptr && replacements->count(id) != 0u;
+  };
+  // Clones |inst| into |linked_context|, pointing it at the globals that are
+  // kept in place of their duplicates.
+  const auto clone = [replacements, linked_context](const Instruction& inst) {
+    std::unique_ptr<Instruction> cloned(inst.Clone(linked_context));
+    if (replacements != nullptr) ReplaceIds(*replacements, cloned.get());
+    return cloned;
+  };
+
+  std::unordered_set<uint32_t> capabilities;
   for (const auto& module : input_modules)
     for (const auto& inst : module->capabilities())
-      linked_module->AddCapability(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      if (!deduplicate ||
+          capabilities.insert(inst.GetSingleWordInOperand(0u)).second)
+        linked_module->AddCapability(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->extensions())
-      linked_module->AddExtension(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExtension(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->ext_inst_imports())
-      linked_module->AddExtInstImport(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      if (!is_replaced(inst.result_id()))
+        linked_module->AddExtInstImport(clone(inst));
 
   do {
     const Instruction* memory_model_inst = input_modules[0]->GetMemoryModel();
@@ -277,8 +492,7 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
     }
 
     if (memory_model_inst != nullptr)
-      linked_module->SetMemoryModel(std::unique_ptr<Instruction>(
-          memory_model_inst->Clone(linked_context)));
+      linked_module->SetMemoryModel(clone(*memory_model_inst));
   } while (false);
 
   std::vector<std::pair<uint32_t, const char*>> entry_points;
@@ -299,35 +513,31 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
                << "The entry point \"" << name << "\", with execution model "
                << desc->name << ", was already defined.";
       }
-      linked_module->AddEntryPoint(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddEntryPoint(clone(inst));
       entry_points.emplace_back(model, name);
     }
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->execution_modes())
-      linked_module->AddExecutionMode(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExecutionMode(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->debugs1())
-      linked_module->AddDebug1Inst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddDebug1Inst(clone(inst));
 
+  // The names of duplicates are dropped along with them.
   for (const auto& module : input_modules)
     for (const auto& inst : module->debugs2())
-      linked_module->AddDebug2Inst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      if (!is_replaced(inst.GetSingleWordInOperand(0u)))
+        linked_module->AddDebug2Inst(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->debugs3())
-      linked_module->AddDebug3Inst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddDebug3Inst(clone(inst));
 
   for (const auto& module : input_modules)
     for (const auto& inst : module->ext_inst_debuginfo())
-      linked_module->AddExtInstDebugInfo(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      linked_module->AddExtInstDebugInfo(clone(inst));
 
   // If the generated module uses SPIR-V 1.1 or higher, add an
   // OpModuleProcessed instruction about the linking step.
@@ -343,10 +553,19 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
                         {{SPV_OPERAND_TYPE_LITERAL_STRING, processed_words}})));
   }
 
+  // Once their targets are replaced, the decorations of duplicates are
+  // identical to those of the globals kept, and are dropped here.
+  std::unordered_set<std::vector<uint32_t>, WordsHash> decorations;
+  std::vector<uint32_t> key;
   for (const auto& module : input_modules)
-    for (const auto& inst : module->annotations())
-      linked_module->AddAnnotationInst(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+    for (const auto& inst : module->annotations()) {
+      if (deduplicate && !inst.HasResultId()) {
+        key.clear();
+        AppendInstructionKey(inst, *replacements, &key);
+        if (!decorations.insert(key).second) continue;
+      }
+      linked_module->AddAnnotationInst(clone(inst));
+    }
 
   // TODO(pierremoreau): Since the modules have not been validate, should we
   //                     expect SpvStorageClassFunction variables outside
@@ -354,8 +573,8 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
   uint32_t num_global_values = 0u;
   for (const auto& module : input_modules) {
     for (const auto& inst : module->types_values()) {
-      linked_module->AddType(
-          std::unique_ptr<Instruction>(inst.Clone(linked_context)));
+      if (is_replaced(inst.result_id())) continue;
+      linked_module->AddType(clone(inst));
       num_global_values += inst.opcode() == SpvOpVariable;
     }
   }
@@ -364,13 +583,28 @@ spv_result_t MergeModules(const MessageConsumer& consumer,
            << "The limit of global values, 65535, was exceeded;"
            << " " << num_global_values << " global values were found.";
 
-  // Process functions and their basic blocks
-  for (const auto& module : input_modules) {
-    for (const auto& func : *module) {
-      std::unique_ptr<opt::Function> cloned_func(func.Clone(linked_context));
+  // Process functions and their basic blocks. Each module is copied on its
+  // own, and the copies are then added in module order.
+  std::vector<std::vector<std::unique_ptr<opt::Function>>> cloned_funcs(
+      input_modules.size());
+  ForEachModule(
+      input_modules.size(), deduplicate,
+      [&input_modules, replacements, linked_context, &cloned_funcs](size_t i) {
+        for (const auto& func : *input_modules[i]) {
+          std::unique_ptr<opt::Function> cloned_func(
+              func.Clone(linked_context));
+          if (replacements != nullptr)
+            cloned_func->ForEachInst(
+                [replacements](Instruction* inst) {
+                  ReplaceIds(*replacements, inst);
+                },
+                true, true);
+          cloned_funcs[i].push_back(std::move(cloned_func));
+        }
+      });
+  for (auto& module_funcs : cloned_funcs)
+    for (auto& cloned_func : module_funcs)
       linked_module->AddFunction(std::move(cloned_func));
-    }
-  }
 
   return SPV_SUCCESS;
 }
@@ -390,6 +624,13 @@ spv_result_t GetImportExportPairs(const MessageConsumer& consumer,
   std::vector<LinkageSymbolInfo> imports;
   std::unordered_map<std::string, std::vector<LinkageSymbolInfo>> exports;
 
+  // range-based for loop calls begin()/end(), but never cbegin()/cend(),
+  // which will not work here.
+  std::unordered_map<SpvId, const opt::Function*> functions;
+  for (auto func_iter = linked_context.module()->cbegin();
+       func_iter != linked_context.module()->cend(); ++func_iter)
+    functions.emplace(func_iter->result_id(), &*func_iter);
+
   // Figure out the imports and exports
   for (const auto& decoration : linked_context.annotations()) {
     if (decoration.opcode() != SpvOpDecorate ||
@@ -431,15 +672,11 @@ spv_result_t GetImportExportPairs(const MessageConsumer& consumer,
     } else if (def_inst->opcode() == SpvOpFunction) {
       symbol_info.type_id = def_inst->GetSingleWordInOperand(1u);
 
-      // range-based for loop calls begin()/end(), but never cbegin()/cend(),
-      // which will not work here.
-      for (auto func_iter = linked_context.module()->cbegin();
-           func_iter != linked_context.module()->cend(); ++func_iter) {
-        if (func_iter->result_id() != id) continue;
-        func_iter->ForEachParam([&symbol_info](const Instruction* inst) {
+      const auto func = functions.find(id);
+      if (func != functions.end())
+        func->second->ForEachParam([&symbol_info](const Instruction* inst) {
           symbol_info.parameter_ids.push_back(inst->result_id());
         });
-      }
     } else {
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
              << "Only global variables and functions can be decorated using"
@@ -534,26 +771,27 @@ spv_result_t RemoveLinkageSpecificInstructions(
   // TODO(pierremoreau): Remove FuncParamAttr decorations of imported
   // functions' return type.
 
+  std::unordered_set<SpvId> imported_symbols;
+  imported_symbols.reserve(linkings_to_do.size());
+  for (const auto& linking_entry : linkings_to_do)
+    imported_symbols.insert(linking_entry.imported_symbol.id);
+
   // Remove prototypes of imported functions
-  for (const auto& linking_entry : linkings_to_do) {
-    for (auto func_iter = linked_context->module()->begin();
-         func_iter != linked_context->module()->end();) {
-      if (func_iter->result_id() == linking_entry.imported_symbol.id)
-        func_iter = func_iter.Erase();
-      else
-        ++func_iter;
-    }
+  for (auto func_iter = linked_context->module()->begin();
+       func_iter != linked_context->module()->end();) {
+    if (imported_symbols.count(func_iter->result_id()))
+      func_iter = func_iter.Erase();
+    else
+      ++func_iter;
   }
 
   // Remove declarations of imported variables
-  for (const auto& linking_entry : linkings_to_do) {
-    auto next = linked_context->types_values_begin();
-    for (auto inst = next; inst != linked_context->types_values_end();
-         inst = next) {
-      ++next;
-      if (inst->result_id() == linking_entry.imported_symbol.id) {
-        linked_context->KillInst(&*inst);
-      }
+  auto next = linked_context->types_values_begin();
+  for (auto inst = next; inst != linked_context->types_values_end();
+       inst = next) {
+    ++next;
+    if (imported_symbols.count(inst->result_id())) {
+      linked_context->KillInst(&*inst);
     }
   }
 
@@ -572,7 +810,7 @@ spv_result_t RemoveLinkageSpecificInstructions(
   }
 
   // Remove import linkage attributes
-  auto next = linked_context->annotation_begin();
+  next = linked_context->annotation_begin();
   for (auto inst = next; inst != linked_context->annotation_end();
        inst = next) {
     ++next;
@@ -668,7 +906,24 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
     return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
            << "No modules were given.";
 
-  std::vector<std::unique_ptr<IRContext>> ir_contexts;
+  // The modules are parsed up front, possibly on several threads; what the
+  // parser reports is passed on in module order, up to the first failure.
+  const bool deduplicate = options.GetDeduplicateWhileMerging();
+  std::vector<std::unique_ptr<IRContext>> ir_contexts(num_binaries);
+  std::vector<std::vector<HeldMessage>> messages(num_binaries);
+  ForEachModule(num_binaries, deduplicate, [&](size_t i) {
+    if (binaries[i][4u] != 0u) return;
+    std::vector<HeldMessage>* held = &messages[i];
+    ir_contexts[i] = BuildModule(
+        c_context->target_env,
+        [held](spv_message_level_t level, const char* source,
+               const spv_position_t& message_position, const char* message) {
+          held->push_back(
+              {level, source ? source : "", message_position, message});
+        },
+        binaries[i], binary_sizes[i]);
+  });
+
   std::vector<Module*> modules;
   modules.reserve(num_binaries);
   for (size_t i = 0u; i < num_binaries; ++i) {
@@ -679,20 +934,23 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
              << "Schema is non-zero for module " << i + 1 << ".";
     }
 
-    std::unique_ptr<IRContext> ir_context = BuildModule(
-        c_context->target_env, consumer, binaries[i], binary_sizes[i]);
-    if (ir_context == nullptr)
+    if (consumer)
+      for (const auto& held : messages[i])
+        consumer(held.level, held.source.c_str(), held.position,
+                 held.message.c_str());
+    if (ir_contexts[i] == nullptr)
       return DiagnosticStream(position, consumer, "", SPV_ERROR_INVALID_BINARY)
              << "Failed to build module " << i + 1 << " out of " << num_binaries
              << ".";
-    modules.push_back(ir_context->module());
-    ir_contexts.push_back(std::move(ir_context));
+    ir_contexts[i]->SetMessageConsumer(consumer);
+    modules.push_back(ir_contexts[i]->module());
   }
 
   // Phase 1: Shift the IDs used in each binary so that they occupy a disjoint
   //          range from the other binaries, and compute the new ID bound.
   uint32_t max_id_bound = 0u;
-  spv_result_t res = ShiftIdsInModules(consumer, &modules, &max_id_bound);
+  spv_result_t res =
+      ShiftIdsInModules(consumer, &modules, deduplicate, &max_id_bound);
   if (res != SPV_SUCCESS) return res;
 
   // Phase 2: Generate the header
@@ -702,9 +960,15 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
   IRContext linked_context(c_context->target_env, consumer);
   linked_context.module()->SetHeader(header);
 
-  // Phase 3: Merge all the binaries into a single one.
+  // Phase 3: Merge all the binaries into a single one, leaving out duplicate
+  //          globals if asked to.
+  IdReplacements replacements;
+  bool has_forward_pointers = false;
+  if (deduplicate)
+    FindDuplicateGlobals(modules, &replacements, &has_forward_pointers);
   AssemblyGrammar grammar(c_context);
-  res = MergeModules(consumer, modules, grammar, &linked_context);
+  res = MergeModules(consumer, modules, grammar,
+                     deduplicate ? &replacements : nullptr, &linked_context);
   if (res != SPV_SUCCESS) return res;
 
   if (options.GetVerifyIds()) {
@@ -725,10 +989,12 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
       CheckImportExportCompatibility(consumer, linkings_to_do, &linked_context);
   if (res != SPV_SUCCESS) return res;
 
-  // Phase 6: Remove duplicates
+  // Phase 6: Remove duplicates, unless they were left out while merging. The
+  //          targets of forward pointers are only compared by the pass.
   PassManager manager;
   manager.SetMessageConsumer(consumer);
-  manager.AddPass<RemoveDuplicatesPass>();
+  if (!deduplicate || has_forward_pointers)
+    manager.AddPass<RemoveDuplicatesPass>();
   opt::Pass::Status pass_res = manager.Run(&linked_context);
   if (pass_res == opt::Pass::Status::Failure) return SPV_ERROR_INVALID_DATA;
 
@@ -21,10 +21,12 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "spirv-tools/libspirv.h"
 
 #include "source/latest_version_spirv_header.h"
+#include "source/opcode.h"
 #include "source/parsed_operand.h"
 
 namespace spvtools {
@@ -54,7 +56,7 @@ FriendlyNameMapper::FriendlyNameMapper(const spv_const_context context,
   spvDiagnosticDestroy(diag);
 }
 
-std::string FriendlyNameMapper::NameForId(uint32_t id) {
+std::string FriendlyNameMapper::NameForId(uint32_t id) const {
   auto iter = name_for_id_.find(id);
   if (iter == name_for_id_.end()) {
     // It must have been an invalid module, so just return a trivial mapping.
@@ -65,6 +67,37 @@ std::string FriendlyNameMapper::NameForId(uint32_t id) {
   }
 }
 
+std::vector<const std::string*> FriendlyNameMapper::GetNameTable() const {
+  // Bound the table by the number of names so that a module with a few huge
+  // Ids doesn't blow up memory.  Those Ids are left to NameForId.
+  const size_t limit = 4 * name_for_id_.size() + 64;
+  size_t size = 0;
+  for (const auto& entry : name_for_id_) {
+    if (entry.first < limit) size = std::max(size, size_t(entry.first) + 1);
+  }
+  std::vector<const std::string*> table(size, nullptr);
+  for (const auto& entry : name_for_id_) {
+    if (entry.first < size) table[entry.first] = &entry.second;
+  }
+  return table;
+}
+
+bool FriendlyNameMapper::IgnoresInstruction(
+    const spv_parsed_instruction_t& inst) const {
+  const SpvOp opcode = static_cast<SpvOp>(inst.opcode);
+  // These can name Ids other than by number, see ParseInstruction.
+  if (opcode == SpvOpName || opcode == SpvOpDecorate ||
+      opcode == SpvOpConstantTrue || opcode == SpvOpConstantFalse ||
+      opcode == SpvOpConstant || spvOpcodeGeneratesType(opcode)) {
+    return false;
+  }
+  if (!inst.result_id ||
+      name_for_id_.find(inst.result_id) != name_for_id_.end()) {
+    return true;
+  }
+  return used_names_.find(to_string(inst.result_id)) == used_names_.end();
+}
+
 std::string FriendlyNameMapper::Sanitize(const std::string& suggested_name) {
   if (suggested_name.empty()) return "_";
   // Otherwise, replace invalid characters by '_'.
@@ -19,6 +19,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "source/assembly_grammar.h"
 #include "spirv-tools/libspirv.h"
@@ -76,7 +77,19 @@ class FriendlyNameMapper {
   // Returns the friendly name for the given id.  If the module parsed during
   // construction is valid, then the mapping satisfies the rules for a
   // NameMapper.
-  std::string NameForId(uint32_t id);
+  std::string NameForId(uint32_t id) const;
+
+  // Returns the names of the Ids defined by the module, indexed by Id.  Entries
+  // are null for Ids without a name, and the table may stop short of the
+  // largest named Id when Ids are sparse.  The pointers remain valid for the
+  // lifetime of this object.
+  std::vector<const std::string*> GetNameTable() const;
+
+  // Returns true if |inst|, appearing after the instructions this mapper has
+  // parsed, would not change any name: it names no Id, and its result Id, if
+  // any, would be named by its number.  This holds for the instructions in
+  // function bodies, unless an earlier OpName took the number as a name.
+  bool IgnoresInstruction(const spv_parsed_instruction_t& inst) const;
 
  private:
   // Transforms the given string so that it is acceptable as an Id name in
@@ -14,6 +14,7 @@
 
 #include "source/opt/def_use_manager.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "source/opt/log.h"
@@ -22,16 +23,56 @@
 namespace spvtools {
 namespace opt {
 namespace analysis {
+namespace {
+
+// Users are kept in the order the old (def, user) set had them: by unique id,
+// with instructions sharing a unique id treated as the same user.
+bool UniqueIdLess(const Instruction* lhs, const Instruction* rhs) {
+  return lhs->unique_id() < rhs->unique_id();
+}
+
+bool SameUniqueId(const Instruction* lhs, const Instruction* rhs) {
+  return lhs->unique_id() == rhs->unique_id();
+}
+
+// Sorts a user list that was filled by appending.
+void SortUsers(std::vector<Instruction*>* users) {
+  if (!std::is_sorted(users->begin(), users->end(), UniqueIdLess)) {
+    std::stable_sort(users->begin(), users->end(), UniqueIdLess);
+  }
+  users->erase(std::unique(users->begin(), users->end(), SameUniqueId),
+               users->end());
+}
+
+// Returns the position in |users| of the first user ordered after an
+// instruction with unique id |unique_id|.
+size_t UsersAfter(const std::vector<Instruction*>& users, uint32_t unique_id) {
+  size_t first = 0;
+  size_t count = users.size();
+  while (count > 0) {
+    const size_t half = count / 2;
+    if (users[first + half]->unique_id() <= unique_id) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return first;
+}
+
+}  // namespace
 
 void DefUseManager::AnalyzeInstDef(Instruction* inst) {
   const uint32_t def_id = inst->result_id();
   if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter != id_to_def_.end()) {
+    Instruction* old_def = GetDef(def_id);
+    if (old_def) {
       // Clear the original instruction that defining the same result id of the
       // new instruction.
-      ClearInst(iter->second);
+      ClearInst(old_def);
     }
+    if (def_id >= id_to_def_.size()) id_to_def_.resize(def_id + 1, nullptr);
     id_to_def_[def_id] = inst;
   } else {
     ClearInst(inst);
@@ -39,6 +80,10 @@ void DefUseManager::AnalyzeInstDef(Instruction* inst) {
 }
 
 void DefUseManager::AnalyzeInstUse(Instruction* inst) {
+  RecordUses(inst, true);
+}
+
+void DefUseManager::RecordUses(Instruction* inst, bool keep_sorted) {
   // Create entry for the given instruction. Note that the instruction may
   // not have any in-operands. In such cases, we still need a entry for those
   // instructions so this manager knows it has seen the instruction later.
@@ -57,9 +102,8 @@ void DefUseManager::AnalyzeInstUse(Instruction* inst) {
       case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       case SPV_OPERAND_TYPE_SCOPE_ID: {
         uint32_t use_id = inst->GetSingleWordOperand(i);
-        Instruction* def = GetDef(use_id);
-        assert(def && "Definition is not registered.");
-        id_to_users_.insert(UserEntry(def, inst));
+        assert(GetDef(use_id) && "Definition is not registered.");
+        AddUser(use_id, inst, keep_sorted);
         used_ids->push_back(use_id);
       } break;
       default:
@@ -68,6 +112,33 @@ void DefUseManager::AnalyzeInstUse(Instruction* inst) {
   }
 }
 
+void DefUseManager::AddUser(uint32_t id, Instruction* user, bool keep_sorted) {
+  if (id >= id_to_users_.size()) id_to_users_.resize(id + 1);
+  UserList& users = id_to_users_[id];
+  if (!keep_sorted) {
+    // An instruction's uses are recorded together, so a repeat is always the
+    // last entry.
+    if (users.empty() || users.back() != user) users.push_back(user);
+    return;
+  }
+  auto iter = std::lower_bound(users.begin(), users.end(), user, UniqueIdLess);
+  if (iter == users.end() || !SameUniqueId(*iter, user)) {
+    users.insert(iter, user);
+  }
+}
+
+void DefUseManager::RemoveUser(uint32_t id, const Instruction* user) {
+  if (id >= id_to_users_.size()) return;
+  UserList& users = id_to_users_[id];
+  auto iter = std::lower_bound(users.begin(), users.end(), user, UniqueIdLess);
+  if (iter != users.end() && SameUniqueId(*iter, user)) users.erase(iter);
+}
+
+const DefUseManager::UserList* DefUseManager::GetUsers(uint32_t id) const {
+  if (id >= id_to_users_.size()) return nullptr;
+  return &id_to_users_[id];
+}
+
 void DefUseManager::AnalyzeInstDefUse(Instruction* inst) {
   AnalyzeInstDef(inst);
   AnalyzeInstUse(inst);
@@ -75,42 +146,18 @@ void DefUseManager::AnalyzeInstDefUse(Instruction* inst) {
 
 void DefUseManager::UpdateDefUse(Instruction* inst) {
   const uint32_t def_id = inst->result_id();
-  if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter == id_to_def_.end()) {
-      AnalyzeInstDef(inst);
-    }
+  if (def_id != 0 && !GetDef(def_id)) {
+    AnalyzeInstDef(inst);
   }
   AnalyzeInstUse(inst);
 }
 
 Instruction* DefUseManager::GetDef(uint32_t id) {
-  auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
+  return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
 }
 
 const Instruction* DefUseManager::GetDef(uint32_t id) const {
-  const auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
-}
-
-DefUseManager::IdToUsersMap::const_iterator DefUseManager::UsersBegin(
-    const Instruction* def) const {
-  return id_to_users_.lower_bound(
-      UserEntry(const_cast<Instruction*>(def), nullptr));
-}
-
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const IdToUsersMap::const_iterator& cached_end,
-                                const Instruction* inst) const {
-  return (iter != cached_end && iter->first == inst);
-}
-
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const Instruction* inst) const {
-  return UsersNotEnd(iter, id_to_users_.end(), inst);
+  return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
 }
 
 bool DefUseManager::WhileEachUser(
@@ -119,10 +166,24 @@ bool DefUseManager::WhileEachUser(
   assert(def && (!def->HasResultId() || def == GetDef(def->result_id())) &&
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
-
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    if (!f(iter->second)) return false;
+  const uint32_t id = def->result_id();
+  if (GetDef(id) != def) return true;
+
+  // |f| may add or remove users of |id| and may even delete |user|, so the
+  // list is looked up again after every call, and iteration carries on after
+  // the last visited user just as it would through an ordered set.
+  size_t index = 0;
+  const UserList* users = GetUsers(id);
+  while (users && index < users->size()) {
+    Instruction* user = (*users)[index];
+    const uint32_t visited = user->unique_id();
+    if (!f(user)) return false;
+    users = GetUsers(id);
+    if (index < users->size() && (*users)[index] == user) {
+      ++index;
+    } else {
+      index = UsersAfter(*users, visited);
+    }
   }
   return true;
 }
@@ -153,19 +214,18 @@ bool DefUseManager::WhileEachUse(
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
 
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    Instruction* user = iter->second;
+  const uint32_t id = def->result_id();
+  return WhileEachUser(def, [id, &f](Instruction* user) {
     for (uint32_t idx = 0; idx != user->NumOperands(); ++idx) {
       const Operand& op = user->GetOperand(idx);
       if (op.type != SPV_OPERAND_TYPE_RESULT_ID && spvIsIdType(op.type)) {
-        if (def->result_id() == op.words[0]) {
+        if (id == op.words[0]) {
           if (!f(user, idx)) return false;
         }
       }
     }
-  }
-  return true;
+    return true;
+  });
 }
 
 bool DefUseManager::WhileEachUse(
@@ -188,9 +248,12 @@ void DefUseManager::ForEachUse(
 }
 
 uint32_t DefUseManager::NumUsers(const Instruction* def) const {
-  uint32_t count = 0;
-  ForEachUser(def, [&count](Instruction*) { ++count; });
-  return count;
+  // Ensure that |def| has been registered.
+  assert(def && (!def->HasResultId() || def == GetDef(def->result_id())) &&
+         "Definition is not registered.");
+  if (!def->HasResultId() || GetDef(def->result_id()) != def) return 0;
+  const UserList* users = GetUsers(def->result_id());
+  return users ? static_cast<uint32_t>(users->size()) : 0;
 }
 
 uint32_t DefUseManager::NumUsers(uint32_t id) const {
@@ -220,28 +283,53 @@ std::vector<Instruction*> DefUseManager::GetAnnotations(uint32_t id) const {
   return annos;
 }
 
+DefUseManager::IdToDefMap DefUseManager::id_to_defs() const {
+  IdToDefMap defs;
+  for (uint32_t id = 0; id < id_to_def_.size(); ++id) {
+    if (id_to_def_[id]) defs[id] = id_to_def_[id];
+  }
+  return defs;
+}
+
+DefUseManager::IdToUsersMap DefUseManager::id_to_users() const {
+  IdToUsersMap users;
+  for (uint32_t id = 0; id < id_to_users_.size(); ++id) {
+    Instruction* def = const_cast<Instruction*>(GetDef(id));
+    if (!def) continue;
+    for (Instruction* user : id_to_users_[id]) {
+      users.insert(UserEntry(def, user));
+    }
+  }
+  return users;
+}
+
 void DefUseManager::AnalyzeDefUse(Module* module) {
   if (!module) return;
+  id_to_def_.resize(module->IdBound(), nullptr);
+  id_to_users_.resize(module->IdBound());
+  inst_to_used_ids_.reserve(module->IdBound());
   // Analyze all the defs before any uses to catch forward references.
   module->ForEachInst(
       std::bind(&DefUseManager::AnalyzeInstDef, this, std::placeholders::_1));
-  module->ForEachInst(
-      std::bind(&DefUseManager::AnalyzeInstUse, this, std::placeholders::_1));
+  // Each instruction is visited once, so its uses can simply be appended and
+  // every list sorted at the end.
+  module->ForEachInst([this](Instruction* inst) {
+    RecordUses(inst, /* keep_sorted = */ false);
+  });
+  for (UserList& users : id_to_users_) SortUsers(&users);
 }
 
 void DefUseManager::ClearInst(Instruction* inst) {
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     EraseUseRecordsOfOperandIds(inst);
-    if (inst->result_id() != 0) {
+    const uint32_t def_id = inst->result_id();
+    if (def_id != 0 && def_id < id_to_def_.size()) {
       // Remove all uses of this inst.
-      auto users_begin = UsersBegin(inst);
-      auto end = id_to_users_.end();
-      auto new_end = users_begin;
-      for (; UsersNotEnd(new_end, end, inst); ++new_end) {
+      if (id_to_def_[def_id] == inst && def_id < id_to_users_.size()) {
+        id_to_users_[def_id].clear();
       }
-      id_to_users_.erase(users_begin, new_end);
-      id_to_def_.erase(inst->result_id());
+      id_to_def_[def_id] = nullptr;
     }
   }
 }
@@ -252,30 +340,28 @@ void DefUseManager::EraseUseRecordsOfOperandIds(const Instruction* inst) {
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     for (auto use_id : iter->second) {
-      id_to_users_.erase(
-          UserEntry(GetDef(use_id), const_cast<Instruction*>(inst)));
+      RemoveUser(use_id, inst);
     }
-    inst_to_used_ids_.erase(inst);
+    inst_to_used_ids_.erase(iter);
   }
 }
 
 bool operator==(const DefUseManager& lhs, const DefUseManager& rhs) {
-  if (lhs.id_to_def_ != rhs.id_to_def_) {
-    return false;
-  }
-
-  if (lhs.id_to_users_ != rhs.id_to_users_) {
-    for (auto p : lhs.id_to_users_) {
-      if (rhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
+  const size_t num_ids =
+      std::max(std::max(lhs.id_to_def_.size(), rhs.id_to_def_.size()),
+               std::max(lhs.id_to_users_.size(), rhs.id_to_users_.size()));
+  for (uint32_t id = 0; id < num_ids; ++id) {
+    if (lhs.GetDef(id) != rhs.GetDef(id)) {
+      return false;
     }
-    for (auto p : rhs.id_to_users_) {
-      if (lhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
+    const DefUseManager::UserList* lhs_users = lhs.GetUsers(id);
+    const DefUseManager::UserList* rhs_users = rhs.GetUsers(id);
+    const size_t lhs_count = lhs_users ? lhs_users->size() : 0;
+    const size_t rhs_count = rhs_users ? rhs_users->size() : 0;
+    if (lhs_count != rhs_count ||
+        (lhs_count != 0 && *lhs_users != *rhs_users)) {
+      return false;
     }
-    return false;
   }
 
   if (lhs.inst_to_used_ids_ != rhs.inst_to_used_ids_) {
@@ -195,10 +195,12 @@ class DefUseManager {
   // instructions which decorate the decoration group will not be returned.
   std::vector<Instruction*> GetAnnotations(uint32_t id) const;
 
-  // Returns the map from ids to their def instructions.
-  const IdToDefMap& id_to_defs() const { return id_to_def_; }
-  // Returns the map from instructions to their users.
-  const IdToUsersMap& id_to_users() const { return id_to_users_; }
+  // Returns a map from ids to their def instructions.  The map is built on
+  // every call, so prefer GetDef() in anything performance sensitive.
+  IdToDefMap id_to_defs() const;
+  // Returns a map from instructions to their users.  The map is built on every
+  // call, so prefer ForEachUser() in anything performance sensitive.
+  IdToUsersMap id_to_users() const;
 
   // Clear the internal def-use record of the given instruction |inst|. This
   // method will update the use information of the operand ids of |inst|. The
@@ -222,29 +224,31 @@ class DefUseManager {
  private:
   using InstToUsedIdsMap =
       std::unordered_map<const Instruction*, std::vector<uint32_t>>;
+  // The users of one id, ordered by unique id and without repeats.
+  using UserList = std::vector<Instruction*>;
 
-  // Returns the first location that {|def|, nullptr} could be inserted into the
-  // users map without violating ordering.
-  IdToUsersMap::const_iterator UsersBegin(const Instruction* def) const;
+  // Returns the users of |id|, or nullptr if nothing has been recorded for it.
+  const UserList* GetUsers(uint32_t id) const;
 
-  // Returns true if |iter| has not reached the end of |def|'s users.
-  //
-  // In the first version |iter| is compared against the end of the map for
-  // validity before other checks. In the second version, |iter| is compared
-  // against |cached_end| for validity before other checks. This allows caching
-  // the map's end which is a performance improvement on some platforms.
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const Instruction* def) const;
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const IdToUsersMap::const_iterator& cached_end,
-                   const Instruction* def) const;
+  // Records that |user| uses |id|.  If |keep_sorted| is false, |user| is just
+  // appended, and the list must be sorted before anything reads it.
+  void AddUser(uint32_t id, Instruction* user, bool keep_sorted);
+
+  // Removes |user| from the users of |id|.
+  void RemoveUser(uint32_t id, const Instruction* user);
+
+  // Records the ids used by |inst|, dropping any uses recorded before.  See
+  // AddUser() for |keep_sorted|.
+  void RecordUses(Instruction* inst, bool keep_sorted);
 
   // Analyzes the defs and uses in the given |module| and populates data
   // structures in this class. Does nothing if |module| is nullptr.
   void AnalyzeDefUse(Module* module);
 
-  IdToDefMap id_to_def_;      // Mapping from ids to their definitions
-  IdToUsersMap id_to_users_;  // Mapping from ids to their users
+  // The def instruction of each id, or nullptr.  Indexed by id.
+  std::vector<Instruction*> id_to_def_;
+  // The instructions using each id.  Indexed by id.
+  std::vector<UserList> id_to_users_;
   // Mapping from instructions to the ids used in the instruction.
   InstToUsedIdsMap inst_to_used_ids_;
 };
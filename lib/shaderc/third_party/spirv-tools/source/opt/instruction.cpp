@@ -14,6 +14,8 @@
 
 #include "source/opt/instruction.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <initializer_list>
 
 #include "OpenCLDebugInfo100.h"
@@ -42,6 +44,30 @@ const uint32_t kDebugNoScopeNumWords = 5;
 // Number of operands of an OpBranchConditional instruction
 // with weights.
 const uint32_t kOpBranchConditionalWithWeightsNumOperands = 5;
+
+// Size of the first block of an InstructionArena.
+const size_t kFirstArenaBlockSize = 64 * 1024;
+
+// Every instruction is preceded by a flag saying whether it came from the heap.
+// The header is padded so the instruction itself stays suitably aligned.
+const size_t kAllocationHeaderSize = alignof(std::max_align_t);
+
+// Appends the operands of |inst| to |operands|.  Words are copied straight into
+// each operand, so the one- and two-word operands that fit inline in an
+// Operand need no allocation at all.
+void CopyOperands(const spv_parsed_instruction_t& inst,
+                  Instruction::OperandList* operands) {
+  operands->reserve(operands->size() + inst.num_operands);
+  for (uint32_t i = 0; i < inst.num_operands; ++i) {
+    const spv_parsed_operand_t& current_payload = inst.operands[i];
+    operands->emplace_back(current_payload.type, Operand::OperandData());
+    Operand::OperandData& words = operands->back().words;
+    words.resize(current_payload.num_words, 0);
+    std::copy(inst.words + current_payload.offset,
+              inst.words + current_payload.offset + current_payload.num_words,
+              words.begin());
+  }
+}
 }  // namespace
 
 Instruction::Instruction(IRContext* c)
@@ -62,6 +88,51 @@ Instruction::Instruction(IRContext* c, SpvOp op)
       unique_id_(c->TakeNextUniqueId()),
       dbg_scope_(kNoDebugScope, kNoInlinedAt) {}
 
+void* InstructionArena::Allocate(size_t size) {
+  // Keep every allocation aligned for any type.
+  const size_t alignment = alignof(std::max_align_t);
+  size = (size + alignment - 1) & ~(alignment - 1);
+  if (size > left_) {
+    // Double the block size each time, so a module is loaded in a few large
+    // allocations whatever its size.
+    next_block_size_ =
+        next_block_size_ ? 2 * next_block_size_ : kFirstArenaBlockSize;
+    const size_t block_size = std::max(size, next_block_size_);
+    blocks_.emplace_back(new char[block_size]);
+    next_ = blocks_.back().get();
+    left_ = block_size;
+  }
+  void* result = next_;
+  next_ += size;
+  left_ -= size;
+  return result;
+}
+
+void* Instruction::operator new(size_t size) {
+  char* memory =
+      static_cast<char*>(::operator new(kAllocationHeaderSize + size));
+  *reinterpret_cast<bool*>(memory) = true;
+  return memory + kAllocationHeaderSize;
+}
+
+void* Instruction::operator new(size_t size, IRContext* context) {
+  char* memory = static_cast<char*>(
+      context->instruction_arena()->Allocate(kAllocationHeaderSize + size));
+  *reinterpret_cast<bool*>(memory) = false;
+  return memory + kAllocationHeaderSize;
+}
+
+void Instruction::operator delete(void* ptr) {
+  if (!ptr) return;
+  char* memory = static_cast<char*>(ptr) - kAllocationHeaderSize;
+  const bool from_heap = *reinterpret_cast<bool*>(memory);
+  if (from_heap) ::operator delete(memory);
+}
+
+void Instruction::operator delete(void* ptr, IRContext*) {
+  Instruction::operator delete(ptr);
+}
+
 Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
                          std::vector<Instruction>&& dbg_line)
     : context_(c),
@@ -73,13 +144,7 @@ Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
       dbg_scope_(kNoDebugScope, kNoInlinedAt) {
   assert((!IsDebugLineInst(opcode_) || dbg_line.empty()) &&
          "Op(No)Line attaching to Op(No)Line found");
-  for (uint32_t i = 0; i < inst.num_operands; ++i) {
-    const auto& current_payload = inst.operands[i];
-    std::vector<uint32_t> words(
-        inst.words + current_payload.offset,
-        inst.words + current_payload.offset + current_payload.num_words);
-    operands_.emplace_back(current_payload.type, std::move(words));
-  }
+  CopyOperands(inst, &operands_);
 }
 
 Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
@@ -90,13 +155,7 @@ Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
       has_result_id_(inst.result_id != 0),
       unique_id_(c->TakeNextUniqueId()),
       dbg_scope_(dbg_scope) {
-  for (uint32_t i = 0; i < inst.num_operands; ++i) {
-    const auto& current_payload = inst.operands[i];
-    std::vector<uint32_t> words(
-        inst.words + current_payload.offset,
-        inst.words + current_payload.offset + current_payload.num_words);
-    operands_.emplace_back(current_payload.type, std::move(words));
-  }
+  CopyOperands(inst, &operands_);
 }
 
 Instruction::Instruction(IRContext* c, SpvOp op, uint32_t ty_id,
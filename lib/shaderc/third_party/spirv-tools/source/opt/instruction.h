@@ -16,6 +16,7 @@
 #define SOURCE_OPT_INSTRUCTION_H_
 
 #include <cassert>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
@@ -43,6 +44,26 @@ class IRContext;
 class Module;
 class InstructionList;
 
+// Memory for the instructions of a module as it is loaded.  Instructions are
+// carved out of a few large blocks, which are released together when the arena
+// is destroyed; deleting one of these instructions runs its destructor but
+// gives nothing back.  Only one thread may allocate from an arena at a time.
+class InstructionArena {
+ public:
+  InstructionArena() : next_(nullptr), left_(0), next_block_size_(0) {}
+  InstructionArena(const InstructionArena&) = delete;
+  InstructionArena& operator=(const InstructionArena&) = delete;
+
+  // Returns |size| bytes aligned for any type.
+  void* Allocate(size_t size);
+
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* next_;
+  size_t left_;
+  size_t next_block_size_;
+};
+
 // Relaxed logical addressing:
 //
 // In the logical addressing model, pointers cannot be stored or loaded.  This
@@ -211,6 +232,17 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
 
   ~Instruction() override = default;
 
+  // Allocates an instruction from the heap.
+  static void* operator new(size_t size);
+  // Allocates an instruction from the instruction arena of |context|.  Use this
+  // only for instructions that will not outlive |context|, as in
+  // new (context) Instruction(context, ...).
+  static void* operator new(size_t size, IRContext* context);
+  // Frees |ptr| if it came from the heap.  Arena memory is released with the
+  // arena.
+  static void operator delete(void* ptr);
+  static void operator delete(void* ptr, IRContext* context);
+
   // Returns a newly allocated instruction that has the same operands, result,
   // and type as |this|.  The new instruction is not linked into any list.
   // It is the responsibility of the caller to make sure that the storage is
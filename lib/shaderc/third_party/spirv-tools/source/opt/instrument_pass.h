@@ -92,6 +92,9 @@ class InstrumentPass : public Pass {
         validation_id_(validation_id),
         opt_direct_reads_(opt_direct_reads) {}
 
+  // The descriptor set and shader id are not part of the name.
+  bool IsIdentifiedByName() const override { return false; }
+
   // Initialize state for instrumentation of module.
   void InitializeInstrument();
 
@@ -14,7 +14,9 @@
 
 #include "source/opt/ir_context.h"
 
+#include <atomic>
 #include <cstring>
+#include <thread>
 
 #include "OpenCLDebugInfo100.h"
 #include "source/latest_version_glsl_std_450_header.h"
@@ -925,6 +927,51 @@ bool IRContext::ProcessCallTreeFromRoots(ProcessFunction& pfn,
   return modified;
 }
 
+void IRContext::CollectEntryPointCallTree(std::vector<Function*>* functions) {
+  std::queue<uint32_t> roots;
+  for (auto& e : module()->entry_points()) {
+    roots.push(e.GetSingleWordInOperand(kEntryPointFunctionIdInIdx));
+  }
+
+  std::unordered_set<uint32_t> done;
+  while (!roots.empty()) {
+    const uint32_t fi = roots.front();
+    roots.pop();
+    if (done.insert(fi).second) {
+      Function* fn = GetFunction(fi);
+      assert(fn && "Trying to process a function that does not exist.");
+      functions->push_back(fn);
+      AddCalls(fn, &roots);
+    }
+  }
+}
+
+void IRContext::AnalyzeFunctions(
+    const std::vector<Function*>& functions,
+    const std::function<void(Function*, size_t)>& analyze) {
+  const size_t num_threads =
+      parallel_functions_
+          ? std::min<size_t>(std::thread::hardware_concurrency(),
+                             functions.size())
+          : 1;
+  if (num_threads < 2) {
+    for (size_t i = 0; i < functions.size(); ++i) analyze(functions[i], i);
+    return;
+  }
+
+  std::atomic<size_t> next_function(0);
+  auto work = [&functions, &analyze, &next_function]() {
+    for (size_t i = next_function++; i < functions.size();
+         i = next_function++) {
+      analyze(functions[i], i);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; ++i) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+}
+
 void IRContext::EmitErrorMessage(std::string message, Instruction* inst) {
   if (!consumer()) {
     return;
@@ -16,6 +16,7 @@
 #define SOURCE_OPT_IR_CONTEXT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -104,7 +105,8 @@ class IRContext {
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        parallel_functions_(false) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
   }
@@ -121,7 +123,8 @@ class IRContext {
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        parallel_functions_(false) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
     InitializeCombinators();
@@ -131,6 +134,9 @@ class IRContext {
 
   Module* module() const { return module_.get(); }
 
+  // Returns the arena that instructions loaded into this context live in.
+  InstructionArena* instruction_arena() { return &instruction_arena_; }
+
   // Returns a vector of pointers to constant-creation instructions in this
   // context.
   inline std::vector<Instruction*> GetConstants();
@@ -452,12 +458,14 @@ class IRContext {
   // Change operands of debug instruction to DebugInfoNone.
   void KillOperandFromDebugInstructions(Instruction* inst);
 
-  // Returns the next unique id for use by an instruction.
+  // Returns the next unique id for use by an instruction.  Safe to call from
+  // several threads, such as when functions are cloned into the context in
+  // parallel.
   inline uint32_t TakeNextUniqueId() {
-    assert(unique_id_ != std::numeric_limits<uint32_t>::max());
-
     // Skip zero.
-    return ++unique_id_;
+    const uint32_t id = unique_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+    assert(id != 0 && "Unique ids ran out");
+    return id;
   }
 
   // Returns true if |inst| is a combinator in the current context.
@@ -554,6 +562,11 @@ class IRContext {
     preserve_spec_constants_ = should_preserve_spec_constants;
   }
 
+  bool parallel_functions() const { return parallel_functions_; }
+  void set_parallel_functions(bool should_analyze_in_parallel) {
+    parallel_functions_ = should_analyze_in_parallel;
+  }
+
   // Return id of input variable only decorated with |builtin|, if in module.
   // Create variable and return its id otherwise. If builtin not currently
   // supported, return 0.
@@ -596,6 +609,19 @@ class IRContext {
   bool ProcessCallTreeFromRoots(ProcessFunction& pfn,
                                 std::queue<uint32_t>* roots);
 
+  // Appends to |functions| every function in the call trees rooted at the
+  // entry points, in the order ProcessEntryPointCallTree visits them as long
+  // as processing does not change any calls.
+  void CollectEntryPointCallTree(std::vector<Function*>* functions);
+
+  // Calls |analyze| with every element of |functions| and its index.  When
+  // parallel_functions() is set the calls are spread over a pool of threads.
+  // |analyze| may then only read the module and analyses that are valid
+  // before this is called, and only write state that belongs to its index.
+  // The caller applies the changes it found serially afterwards.
+  void AnalyzeFunctions(const std::vector<Function*>& functions,
+                        const std::function<void(Function*, size_t)>& analyze);
+
   // Emmits a error message to the message consumer indicating the error
   // described by |message| occurred in |inst|.
   void EmitErrorMessage(std::string message, Instruction* inst);
@@ -750,7 +776,11 @@ class IRContext {
   //
   // This member is initialized to 0, but always issues this value plus one.
   // Therefore, 0 is not a valid unique id for an instruction.
-  uint32_t unique_id_;
+  std::atomic<uint32_t> unique_id_;
+
+  // Storage for the instructions created while loading |module_|.  Declared
+  // before |module_| so it outlives every instruction it holds.
+  InstructionArena instruction_arena_;
 
   // The module being processed within this IR context.
   std::unique_ptr<Module> module_;
@@ -834,6 +864,9 @@ class IRContext {
   // Whether all specialization constants within |module_|
   // should be preserved.
   bool preserve_spec_constants_;
+
+  // Whether passes that support it analyze functions on multiple threads.
+  bool parallel_functions_;
 };
 
 inline IRContext::Analysis operator|(IRContext::Analysis lhs,
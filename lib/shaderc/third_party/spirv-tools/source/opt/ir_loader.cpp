@@ -91,7 +91,8 @@ bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
   }
 
   std::unique_ptr<Instruction> spv_inst(
-      new Instruction(module()->context(), *inst, std::move(dbg_line_info_)));
+      new (module()->context())
+          Instruction(module()->context(), *inst, std::move(dbg_line_info_)));
   if (!spv_inst->dbg_line_insts().empty()) {
     if (extra_line_tracking_ &&
         (spv_inst->dbg_line_insts().back().opcode() != SpvOpNoLine)) {
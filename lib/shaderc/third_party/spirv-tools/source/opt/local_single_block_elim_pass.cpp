@@ -53,26 +53,59 @@ bool LocalSingleBlockLoadStoreElimPass::HasOnlySupportedRefs(uint32_t ptrId) {
   return false;
 }
 
-bool LocalSingleBlockLoadStoreElimPass::LocalSingleBlockLoadStoreElim(
-    Function* func) {
-  // Perform local store/load, load/load and store/store elimination
-  // on each block
-  bool modified = false;
-  std::vector<Instruction*> instructions_to_kill;
+void LocalSingleBlockLoadStoreElimPass::CollectTargetVars(
+    const std::vector<Function*>& functions) {
+  // The analysis of each function reads these without building them.
+  get_def_use_mgr();
+  analysis::DebugInfoManager* debug_info_mgr = context()->get_debug_info_mgr();
+
+  target_vars_.clear();
+  for (Function* func : functions) {
+    // Function scope variables are declared in the entry block.
+    for (auto& inst : *func->entry()) {
+      if (inst.opcode() != SpvOpVariable) continue;
+      const uint32_t varId = inst.result_id();
+      if (!IsTargetVar(varId) || !HasOnlySupportedRefs(varId)) continue;
+      target_vars_[varId] = debug_info_mgr->IsVariableDebugDeclared(varId);
+    }
+  }
+}
+
+void LocalSingleBlockLoadStoreElimPass::AnalyzeFunction(
+    Function* func, FunctionChanges* changes) {
+  // Map from function scope variable to a store of that variable in the
+  // current block whose value is currently valid. This map is cleared
+  // at the start of each block and incrementally updated as the block
+  // is scanned. The stores are candidates for elimination. The map is
+  // conservatively cleared when a function call is encountered.
+  std::unordered_map<uint32_t, Instruction*> var2store;
+
+  // Map from function scope variable to a load of that variable in the
+  // current block whose value is currently valid. Cleared like |var2store|.
+  std::unordered_map<uint32_t, Instruction*> var2load;
+
+  // The replacement of each load found so far.  Nothing is rewritten until
+  // the changes are applied, so stored values still name replaced loads and
+  // are looked up here.
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  auto stored_value = [&replacements](const Instruction* store) {
+    const uint32_t valId = store->GetSingleWordInOperand(kStoreValIdInIdx);
+    auto replacement = replacements.find(valId);
+    return replacement == replacements.end() ? valId : replacement->second;
+  };
+
   std::unordered_set<Instruction*> instructions_to_save;
   for (auto bi = func->begin(); bi != func->end(); ++bi) {
-    var2store_.clear();
-    var2load_.clear();
-    auto next = bi->begin();
-    for (auto ii = next; ii != bi->end(); ii = next) {
-      ++next;
+    var2store.clear();
+    var2load.clear();
+    for (auto ii = bi->begin(); ii != bi->end(); ++ii) {
       switch (ii->opcode()) {
         case SpvOpStore: {
           // Verify store variable is target type
           uint32_t varId;
           Instruction* ptrInst = GetPtr(&*ii, &varId);
-          if (!IsTargetVar(varId)) continue;
-          if (!HasOnlySupportedRefs(varId)) continue;
+          auto target_var = target_vars_.find(varId);
+          if (target_var == target_vars_.end()) continue;
           // If a store to the whole variable, remember it for succeeding
           // loads and stores. Otherwise forget any previous store to that
           // variable.
@@ -80,20 +113,17 @@ bool LocalSingleBlockLoadStoreElimPass::LocalSingleBlockLoadStoreElim(
             // If a previous store to same variable, mark the store
             // for deletion if not still used. Don't delete store
             // if debugging; let ssa-rewrite and DCE handle it
-            auto prev_store = var2store_.find(varId);
-            if (prev_store != var2store_.end() &&
+            auto prev_store = var2store.find(varId);
+            if (prev_store != var2store.end() &&
                 instructions_to_save.count(prev_store->second) == 0 &&
-                !context()->get_debug_info_mgr()->IsVariableDebugDeclared(
-                    varId)) {
-              instructions_to_kill.push_back(prev_store->second);
-              modified = true;
+                !target_var->second) {
+              changes->killed_insts.push_back(prev_store->second);
             }
 
             bool kill_store = false;
-            auto li = var2load_.find(varId);
-            if (li != var2load_.end()) {
-              if (ii->GetSingleWordInOperand(kStoreValIdInIdx) ==
-                  li->second->result_id()) {
+            auto li = var2load.find(varId);
+            if (li != var2load.end()) {
+              if (stored_value(&*ii) == li->second->result_id()) {
                 // We are storing the same value that already exists in the
                 // memory location.  The store does nothing.
                 kill_store = true;
@@ -101,71 +131,77 @@ bool LocalSingleBlockLoadStoreElimPass::LocalSingleBlockLoadStoreElim(
             }
 
             if (!kill_store) {
-              var2store_[varId] = &*ii;
-              var2load_.erase(varId);
+              var2store[varId] = &*ii;
+              var2load.erase(varId);
             } else {
-              instructions_to_kill.push_back(&*ii);
-              modified = true;
+              changes->killed_insts.push_back(&*ii);
             }
           } else {
             assert(IsNonPtrAccessChain(ptrInst->opcode()));
-            var2store_.erase(varId);
-            var2load_.erase(varId);
+            var2store.erase(varId);
+            var2load.erase(varId);
           }
         } break;
         case SpvOpLoad: {
           // Verify store variable is target type
           uint32_t varId;
           Instruction* ptrInst = GetPtr(&*ii, &varId);
-          if (!IsTargetVar(varId)) continue;
-          if (!HasOnlySupportedRefs(varId)) continue;
+          if (target_vars_.count(varId) == 0) continue;
           uint32_t replId = 0;
           if (ptrInst->opcode() == SpvOpVariable) {
             // If a load from a variable, look for a previous store or
             // load from that variable and use its value.
-            auto si = var2store_.find(varId);
-            if (si != var2store_.end()) {
-              replId = si->second->GetSingleWordInOperand(kStoreValIdInIdx);
+            auto si = var2store.find(varId);
+            if (si != var2store.end()) {
+              replId = stored_value(si->second);
             } else {
-              auto li = var2load_.find(varId);
-              if (li != var2load_.end()) {
+              auto li = var2load.find(varId);
+              if (li != var2load.end()) {
                 replId = li->second->result_id();
               }
             }
           } else {
             // If a partial load of a previously seen store, remember
             // not to delete the store.
-            auto si = var2store_.find(varId);
-            if (si != var2store_.end()) instructions_to_save.insert(si->second);
+            auto si = var2store.find(varId);
+            if (si != var2store.end()) instructions_to_save.insert(si->second);
           }
           if (replId != 0) {
             // replace load's result id and delete load
-            context()->KillNamesAndDecorates(&*ii);
-            context()->ReplaceAllUsesWith(ii->result_id(), replId);
-            instructions_to_kill.push_back(&*ii);
-            modified = true;
+            replacements[ii->result_id()] = replId;
+            changes->replaced_loads.emplace_back(&*ii, replId);
+            changes->killed_insts.push_back(&*ii);
           } else {
             if (ptrInst->opcode() == SpvOpVariable)
-              var2load_[varId] = &*ii;  // register load
+              var2load[varId] = &*ii;  // register load
           }
         } break;
         case SpvOpFunctionCall: {
           // Conservatively assume all locals are redefined for now.
           // TODO(): Handle more optimally
-          var2store_.clear();
-          var2load_.clear();
+          var2store.clear();
+          var2load.clear();
         } break;
         default:
           break;
       }
     }
   }
+}
+
+bool LocalSingleBlockLoadStoreElimPass::ApplyChanges(
+    const FunctionChanges& changes) {
+  for (const auto& replaced_load : changes.replaced_loads) {
+    context()->KillNamesAndDecorates(replaced_load.first);
+    context()->ReplaceAllUsesWith(replaced_load.first->result_id(),
+                                  replaced_load.second);
+  }
 
-  for (Instruction* inst : instructions_to_kill) {
+  for (Instruction* inst : changes.killed_insts) {
     context()->KillInst(inst);
   }
 
-  return modified;
+  return !changes.killed_insts.empty();
 }
 
 void LocalSingleBlockLoadStoreElimPass::Initialize() {
@@ -204,12 +240,22 @@ Pass::Status LocalSingleBlockLoadStoreElimPass::ProcessImpl() {
   // If any extensions in the module are not explicitly supported,
   // return unmodified.
   if (!AllExtensionsSupported()) return Status::SuccessWithoutChange;
-  // Process all entry point functions
-  ProcessFunction pfn = [this](Function* fp) {
-    return LocalSingleBlockLoadStoreElim(fp);
-  };
+  // Process all entry point functions.  Each function is analyzed on its own,
+  // possibly concurrently, and the changes are applied in call tree order.
+  std::vector<Function*> functions;
+  context()->CollectEntryPointCallTree(&functions);
+  CollectTargetVars(functions);
+
+  std::vector<FunctionChanges> changes(functions.size());
+  context()->AnalyzeFunctions(functions,
+                              [this, &changes](Function* func, size_t index) {
+                                AnalyzeFunction(func, &changes[index]);
+                              });
 
-  bool modified = context()->ProcessEntryPointCallTree(pfn);
+  bool modified = false;
+  for (const FunctionChanges& function_changes : changes) {
+    modified |= ApplyChanges(function_changes);
+  }
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
@@ -24,6 +24,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "source/opt/basic_block.h"
 #include "source/opt/def_use_manager.h"
@@ -55,13 +56,30 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   // implementation?
   bool HasOnlySupportedRefs(uint32_t varId);
 
-  // On all entry point functions, within each basic block, eliminate
-  // loads and stores to function variables where possible. For
-  // loads, if previous load or store to same variable, replace
-  // load id with previous id and delete load. Finally, check if
-  // remaining stores are useless, and delete store and variable
-  // where possible. Assumes logical addressing.
-  bool LocalSingleBlockLoadStoreElim(Function* func);
+  // The changes found in one function.  They are applied once every function
+  // has been analyzed.
+  struct FunctionChanges {
+    // Loads to replace, each with the id that replaces it, in program order.
+    std::vector<std::pair<Instruction*, uint32_t>> replaced_loads;
+
+    // Loads and stores to delete.
+    std::vector<Instruction*> killed_insts;
+  };
+
+  // Records in |target_vars_| the function scope variables of |functions|
+  // whose loads and stores this pass can eliminate.
+  void CollectTargetVars(const std::vector<Function*>& functions);
+
+  // Within each basic block of |func|, finds the loads and stores of
+  // variables in |target_vars_| that can be eliminated. A load with an
+  // earlier load or store of the same variable is replaced by that value, and
+  // a store that is overwritten in the block without being read is deleted.
+  // Only reads the module, so functions can be analyzed concurrently.
+  // Assumes logical addressing.
+  void AnalyzeFunction(Function* func, FunctionChanges* changes);
+
+  // Applies |changes|.  Returns true if the module changed.
+  bool ApplyChanges(const FunctionChanges& changes);
 
   // Initialize extensions allowlist
   void InitExtensions();
@@ -72,19 +90,10 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   void Initialize();
   Pass::Status ProcessImpl();
 
-  // Map from function scope variable to a store of that variable in the
-  // current block whose value is currently valid. This map is cleared
-  // at the start of each block and incrementally updated as the block
-  // is scanned. The stores are candidates for elimination. The map is
-  // conservatively cleared when a function call is encountered.
-  std::unordered_map<uint32_t, Instruction*> var2store_;
-
-  // Map from function scope variable to a load of that variable in the
-  // current block whose value is currently valid. This map is cleared
-  // at the start of each block and incrementally updated as the block
-  // is scanned. The stores are candidates for elimination. The map is
-  // conservatively cleared when a function call is encountered.
-  std::unordered_map<uint32_t, Instruction*> var2load_;
+  // Function scope variables whose loads and stores can be eliminated,
+  // mapped to whether they are described by a DebugDeclare.  Built before the
+  // functions are analyzed, so the analysis only reads it.
+  std::unordered_map<uint32_t, bool> target_vars_;
 
   // Set of variables whose most recent store in the current block cannot be
   // deleted, for example, if there is a load of the variable which is
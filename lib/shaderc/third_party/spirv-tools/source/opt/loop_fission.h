@@ -56,6 +56,7 @@ class LoopFissionPass : public Pass {
       : split_criteria_(functor), split_multiple_times_(split_multiple_times) {}
 
   const char* name() const override { return "loop-fission"; }
+  bool IsIdentifiedByName() const override { return false; }
 
   Pass::Status Process() override;
 
@@ -30,6 +30,7 @@ class LoopFusionPass : public Pass {
       : Pass(), max_registers_per_loop_(max_registers_per_loop) {}
 
   const char* name() const override { return "loop-fusion"; }
+  bool IsIdentifiedByName() const override { return false; }
 
   // Processes the given |module|. Returns Status::Failure if errors occur when
   // processing. Returns the corresponding Status::Success if processing is
@@ -27,6 +27,7 @@ class LoopUnroller : public Pass {
       : Pass(), fully_unroll_(fully_unroll), unroll_factor_(unroll_factor) {}
 
   const char* name() const override { return "loop-unroll"; }
+  bool IsIdentifiedByName() const override { return false; }
 
   Status Process() override;
 
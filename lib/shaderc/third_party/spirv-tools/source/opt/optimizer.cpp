@@ -15,7 +15,12 @@
 #include "spirv-tools/optimizer.hpp"
 
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -56,12 +61,144 @@ Optimizer::PassToken& Optimizer::PassToken::operator=(PassToken&& that) {
 Optimizer::PassToken::~PassToken() {}
 
 struct Optimizer::Impl {
-  explicit Impl(spv_target_env env) : target_env(env), pass_manager() {}
+  explicit Impl(spv_target_env env)
+      : target_env(env), pass_manager(), num_described_passes(0) {}
+
+  // Records that the passes registered from |first_pass| on were created from
+  // |flag|, as long as all passes before them were created from flags too.
+  void DescribePasses(uint32_t first_pass, const std::string& flag) {
+    if (num_described_passes != first_pass) return;
+    num_described_passes = pass_manager.NumPasses();
+    pass_flags.push_back(flag);
+  }
 
   spv_target_env target_env;      // Target environment.
   opt::PassManager pass_manager;  // Internal implementation pass manager.
+
+  // The flags that the first |num_described_passes| passes were created from.
+  // A run can only use the cache when that covers every registered pass.
+  std::vector<std::string> pass_flags;
+  uint32_t num_described_passes;
+
+  std::string cache_directory;  // Where results are kept, empty for none.
 };
 
+namespace {
+
+// Two independent hashes of |binary|, so that together they identify it.
+void HashBinary(const uint32_t* binary, size_t size, uint64_t* fnv,
+                uint64_t* mixed) {
+  *fnv = 14695981039346656037ull;
+  *mixed = size;
+  for (size_t i = 0; i < size; ++i) {
+    *fnv = (*fnv ^ binary[i]) * 1099511628211ull;
+    uint64_t word = (*mixed ^ binary[i]) + 0x9e3779b97f4a7c15ull;
+    word = (word ^ (word >> 30)) * 0xbf58476d1ce4e5b9ull;
+    word = (word ^ (word >> 27)) * 0x94d049bb133111ebull;
+    *mixed = word ^ (word >> 31);
+  }
+}
+
+// Returns everything that decides the result of optimizing a binary with
+// hashes |fnv| and |mixed| of |size| words.
+std::string CacheKey(spv_target_env env, const spv_optimizer_options_t& options,
+                     const std::vector<std::string>& pass_flags, size_t size,
+                     uint64_t fnv, uint64_t mixed) {
+  const spv_validator_options_t& val = options.val_options_;
+  const validator_universal_limits_t& limits = val.universal_limits_;
+  std::ostringstream key;
+  key << "spirv-opt cache 1\n"
+      << "binary " << size << " " << fnv << " " << mixed << "\n"
+      << "env " << env << "\n"
+      << "options " << options.run_validator_ << options.preserve_bindings_
+      << options.preserve_spec_constants_ << " " << options.max_id_bound_
+      << "\n"
+      << "validator " << val.relax_struct_store << val.relax_logical_pointer
+      << val.relax_block_layout << val.uniform_buffer_standard_layout
+      << val.scalar_block_layout << val.workgroup_scalar_block_layout
+      << val.skip_block_layout << val.before_hlsl_legalization << "\n"
+      << "limits " << limits.max_struct_members << " "
+      << limits.max_struct_depth << " " << limits.max_local_variables << " "
+      << limits.max_global_variables << " " << limits.max_switch_branches
+      << " " << limits.max_function_args << " "
+      << limits.max_control_flow_nesting_depth << " "
+      << limits.max_access_chain_indexes << " " << limits.max_id_bound
+      << "\n";
+  for (const std::string& flag : pass_flags) key << "pass " << flag << "\n";
+  return key.str();
+}
+
+// Returns the file in |directory| for results with |key|.
+std::string CachePath(const std::string& directory, const std::string& key) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : key) hash = (hash ^ uint8_t(c)) * 1099511628211ull;
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.spvcache",
+           static_cast<unsigned long long>(hash));
+  return directory + name;
+}
+
+// A cache file holds the size of its key, the key padded to whole words, and
+// the optimized binary.
+bool ReadCachedResult(const std::string& path, const std::string& key,
+                      std::vector<uint32_t>* binary) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) return false;
+  const std::streamoff file_size = file.tellg();
+  const size_t key_words = (key.size() + 3) / 4;
+  if (file_size < std::streamoff((1 + key_words) * 4)) return false;
+  file.seekg(0);
+
+  uint32_t key_size = 0;
+  std::string stored_key(key_words * 4, '\0');
+  file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+  file.read(&stored_key[0], std::streamsize(stored_key.size()));
+  if (!file || key_size != key.size() ||
+      stored_key.compare(0, key.size(), key) != 0) {
+    return false;
+  }
+
+  std::vector<uint32_t> result(size_t(file_size) / 4 - 1 - key_words);
+  file.read(reinterpret_cast<char*>(result.data()),
+            std::streamsize(result.size() * 4));
+  if (!file) return false;
+  *binary = std::move(result);
+  return true;
+}
+
+// Writes to a file of its own and renames it into place, so runs that share
+// the directory never see half a result.
+void WriteCachedResult(const std::string& path, const std::string& key,
+                       const std::vector<uint32_t>& binary) {
+  const std::string temp_path =
+      path + "." +
+      std::to_string(
+          std::chrono::steady_clock::now().time_since_epoch().count()) +
+      "." + std::to_string(reinterpret_cast<uintptr_t>(&binary));
+  {
+    std::ofstream file(temp_path, std::ios::binary);
+    if (!file) return;
+    const uint32_t key_size = uint32_t(key.size());
+    std::string padded_key = key;
+    padded_key.resize((key.size() + 3) / 4 * 4, '\0');
+    file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+    file.write(padded_key.data(), std::streamsize(padded_key.size()));
+    file.write(reinterpret_cast<const char*>(binary.data()),
+               std::streamsize(binary.size() * 4));
+    if (!file) {
+      file.close();
+      std::remove(temp_path.c_str());
+      return;
+    }
+  }
+  // Another run may have stored the same result first.
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+  }
+}
+
+}  // namespace
+
 Optimizer::Optimizer(spv_target_env env) : impl_(new Impl(env)) {
   assert(env != SPV_ENV_WEBGPU_0);
 }
@@ -109,57 +246,60 @@ Optimizer& Optimizer::RegisterPass(PassToken&& p) {
 // problem.  The optimization we use are all used to either do copy propagation
 // or enable more copy propagation.
 Optimizer& Optimizer::RegisterLegalizationPasses() {
-  return
-      // Wrap OpKill instructions so all other code can be inlined.
-      RegisterPass(CreateWrapOpKillPass())
-          // Remove unreachable block so that merge return works.
-          .RegisterPass(CreateDeadBranchElimPass())
-          // Merge the returns so we can inline.
-          .RegisterPass(CreateMergeReturnPass())
-          // Make sure uses and definitions are in the same function.
-          .RegisterPass(CreateInlineExhaustivePass())
-          // Make private variable function scope
-          .RegisterPass(CreateEliminateDeadFunctionsPass())
-          .RegisterPass(CreatePrivateToLocalPass())
-          // Fix up the storage classes that DXC may have purposely generated
-          // incorrectly.  All functions are inlined, and a lot of dead code has
-          // been removed.
-          .RegisterPass(CreateFixStorageClassPass())
-          // Propagate the value stored to the loads in very simple cases.
-          .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-          .RegisterPass(CreateLocalSingleStoreElimPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          // Split up aggregates so they are easier to deal with.
-          .RegisterPass(CreateScalarReplacementPass(0))
-          // Remove loads and stores so everything is in intermediate values.
-          // Takes care of copy propagation of non-members.
-          .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-          .RegisterPass(CreateLocalSingleStoreElimPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          .RegisterPass(CreateLocalMultiStoreElimPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          // Propagate constants to get as many constant conditions on branches
-          // as possible.
-          .RegisterPass(CreateCCPPass())
-          .RegisterPass(CreateLoopUnrollPass(true))
-          .RegisterPass(CreateDeadBranchElimPass())
-          // Copy propagate members.  Cleans up code sequences generated by
-          // scalar replacement.  Also important for removing OpPhi nodes.
-          .RegisterPass(CreateSimplificationPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          .RegisterPass(CreateCopyPropagateArraysPass())
-          // May need loop unrolling here see
-          // https://github.com/Microsoft/DirectXShaderCompiler/pull/930
-          // Get rid of unused code that contain traces of illegal code
-          // or unused references to unbound external objects
-          .RegisterPass(CreateVectorDCEPass())
-          .RegisterPass(CreateDeadInsertElimPass())
-          .RegisterPass(CreateReduceLoadSizePass())
-          .RegisterPass(CreateAggressiveDCEPass());
+  const uint32_t first_pass = impl_->pass_manager.NumPasses();
+  // Wrap OpKill instructions so all other code can be inlined.
+  RegisterPass(CreateWrapOpKillPass())
+      // Remove unreachable block so that merge return works.
+      .RegisterPass(CreateDeadBranchElimPass())
+      // Merge the returns so we can inline.
+      .RegisterPass(CreateMergeReturnPass())
+      // Make sure uses and definitions are in the same function.
+      .RegisterPass(CreateInlineExhaustivePass())
+      // Make private variable function scope
+      .RegisterPass(CreateEliminateDeadFunctionsPass())
+      .RegisterPass(CreatePrivateToLocalPass())
+      // Fix up the storage classes that DXC may have purposely generated
+      // incorrectly.  All functions are inlined, and a lot of dead code has
+      // been removed.
+      .RegisterPass(CreateFixStorageClassPass())
+      // Propagate the value stored to the loads in very simple cases.
+      .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
+      .RegisterPass(CreateLocalSingleStoreElimPass())
+      .RegisterPass(CreateAggressiveDCEPass())
+      // Split up aggregates so they are easier to deal with.
+      .RegisterPass(CreateScalarReplacementPass(0))
+      // Remove loads and stores so everything is in intermediate values.
+      // Takes care of copy propagation of non-members.
+      .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
+      .RegisterPass(CreateLocalSingleStoreElimPass())
+      .RegisterPass(CreateAggressiveDCEPass())
+      .RegisterPass(CreateLocalMultiStoreElimPass())
+      .RegisterPass(CreateAggressiveDCEPass())
+      // Propagate constants to get as many constant conditions on branches
+      // as possible.
+      .RegisterPass(CreateCCPPass())
+      .RegisterPass(CreateLoopUnrollPass(true))
+      .RegisterPass(CreateDeadBranchElimPass())
+      // Copy propagate members.  Cleans up code sequences generated by
+      // scalar replacement.  Also important for removing OpPhi nodes.
+      .RegisterPass(CreateSimplificationPass())
+      .RegisterPass(CreateAggressiveDCEPass())
+      .RegisterPass(CreateCopyPropagateArraysPass())
+      // May need loop unrolling here see
+      // https://github.com/Microsoft/DirectXShaderCompiler/pull/930
+      // Get rid of unused code that contain traces of illegal code
+      // or unused references to unbound external objects
+      .RegisterPass(CreateVectorDCEPass())
+      .RegisterPass(CreateDeadInsertElimPass())
+      .RegisterPass(CreateReduceLoadSizePass())
+      .RegisterPass(CreateAggressiveDCEPass());
+  impl_->DescribePasses(first_pass, "--legalize-hlsl");
+  return *this;
 }
 
 Optimizer& Optimizer::RegisterPerformancePasses() {
-  return RegisterPass(CreateWrapOpKillPass())
+  const uint32_t first_pass = impl_->pass_manager.NumPasses();
+  RegisterPass(CreateWrapOpKillPass())
       .RegisterPass(CreateDeadBranchElimPass())
       .RegisterPass(CreateMergeReturnPass())
       .RegisterPass(CreateInlineExhaustivePass())
@@ -203,10 +343,13 @@ Optimizer& Optimizer::RegisterPerformancePasses() {
       .RegisterPass(CreateDeadBranchElimPass())
       .RegisterPass(CreateBlockMergePass())
       .RegisterPass(CreateSimplificationPass());
+  impl_->DescribePasses(first_pass, "-O");
+  return *this;
 }
 
 Optimizer& Optimizer::RegisterSizePasses() {
-  return RegisterPass(CreateWrapOpKillPass())
+  const uint32_t first_pass = impl_->pass_manager.NumPasses();
+  RegisterPass(CreateWrapOpKillPass())
       .RegisterPass(CreateDeadBranchElimPass())
       .RegisterPass(CreateMergeReturnPass())
       .RegisterPass(CreateInlineExhaustivePass())
@@ -239,6 +382,8 @@ Optimizer& Optimizer::RegisterSizePasses() {
       .RegisterPass(CreateSimplificationPass())
       .RegisterPass(CreateAggressiveDCEPass())
       .RegisterPass(CreateCFGCleanupPass());
+  impl_->DescribePasses(first_pass, "-Os");
+  return *this;
 }
 
 bool Optimizer::RegisterPassesFromFlags(const std::vector<std::string>& flags) {
@@ -270,6 +415,7 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   if (!FlagHasValidForm(flag)) {
     return false;
   }
+  const uint32_t first_pass = impl_->pass_manager.NumPasses();
 
   // Split flags of the form --pass_name=pass_args.
   auto p = utils::SplitFlagArgs(flag);
@@ -501,6 +647,7 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     return false;
   }
 
+  impl_->DescribePasses(first_pass, flag);
   return true;
 }
 
@@ -531,6 +678,28 @@ bool Optimizer::Run(const uint32_t* original_binary,
                     const size_t original_binary_size,
                     std::vector<uint32_t>* optimized_binary,
                     const spv_optimizer_options opt_options) const {
+  // The stored result was made after validating the same input with the same
+  // options, so a hit needs neither.
+  std::string cache_key;
+  std::string cache_path;
+  if (!impl_->cache_directory.empty() &&
+      impl_->num_described_passes == impl_->pass_manager.NumPasses()) {
+    uint64_t fnv, mixed;
+    HashBinary(original_binary, original_binary_size, &fnv, &mixed);
+    cache_key = CacheKey(impl_->target_env, *opt_options, impl_->pass_flags,
+                         original_binary_size, fnv, mixed);
+    cache_path = CachePath(impl_->cache_directory, cache_key);
+    std::vector<uint32_t> cached_binary;
+    if (ReadCachedResult(cache_path, cache_key, &cached_binary)) {
+      // The passes are used up, as they are by a run.
+      impl_->pass_manager.ClearPasses();
+      impl_->pass_flags.clear();
+      impl_->num_described_passes = 0;
+      *optimized_binary = std::move(cached_binary);
+      return true;
+    }
+  }
+
   spvtools::SpirvTools tools(impl_->target_env);
   tools.SetMessageConsumer(impl_->pass_manager.consumer());
   if (opt_options->run_validator_ &&
@@ -546,10 +715,13 @@ bool Optimizer::Run(const uint32_t* original_binary,
   context->set_max_id_bound(opt_options->max_id_bound_);
   context->set_preserve_bindings(opt_options->preserve_bindings_);
   context->set_preserve_spec_constants(opt_options->preserve_spec_constants_);
+  context->set_parallel_functions(opt_options->parallel_functions_);
 
   impl_->pass_manager.SetValidatorOptions(&opt_options->val_options_);
   impl_->pass_manager.SetTargetEnv(impl_->target_env);
   auto status = impl_->pass_manager.Run(context.get());
+  impl_->pass_flags.clear();
+  impl_->num_described_passes = 0;
 
   if (status == opt::Pass::Status::Failure) {
     return false;
@@ -582,6 +754,9 @@ bool Optimizer::Run(const uint32_t* original_binary,
   optimized_binary->clear();
   context->module()->ToBinary(optimized_binary, /* skip_nop = */ true);
 
+  if (!cache_path.empty()) {
+    WriteCachedResult(cache_path, cache_key, *optimized_binary);
+  }
   return true;
 }
 
@@ -600,6 +775,16 @@ Optimizer& Optimizer::SetValidateAfterAll(bool validate) {
   return *this;
 }
 
+Optimizer& Optimizer::SetSkipUnchangedPasses(bool skip) {
+  impl_->pass_manager.SetSkipUnchangedPasses(skip);
+  return *this;
+}
+
+Optimizer& Optimizer::SetCacheDirectory(const std::string& path) {
+  impl_->cache_directory = path;
+  return *this;
+}
+
 Optimizer::PassToken CreateNullPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::NullPass>());
 }
@@ -106,6 +106,11 @@ class Pass {
     return IRContext::kAnalysisNone;
   }
 
+  // Returns true if every pass with this name makes the same changes to the
+  // same module.  Passes whose behavior depends on settings that their name
+  // does not show return false, so PassManager never skips them.
+  virtual bool IsIdentifiedByName() const { return true; }
+
   // Return type id for |ptrInst|'s pointee
   uint32_t GetPointeeTypeId(const Instruction* ptrInst) const;
 
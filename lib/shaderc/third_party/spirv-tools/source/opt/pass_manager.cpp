@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "source/opt/ir_context.h"
@@ -35,7 +36,7 @@ Pass::Status PassManager::Run(IRContext* context) {
     if (print_all_stream_) {
       std::vector<uint32_t> binary;
       context->module()->ToBinary(&binary, false);
-      SpirvTools t(SPV_ENV_UNIVERSAL_1_2);
+      SpirvTools t(target_env_);
       std::string disassembly;
       t.Disassemble(binary, &disassembly, 0);
       *print_all_stream_ << preamble << (pass ? pass->name() : "") << "\n"
@@ -43,13 +44,30 @@ Pass::Status PassManager::Run(IRContext* context) {
     }
   };
 
+  // The names of the passes that ran without a change since the module last
+  // changed.
+  std::unordered_set<std::string> unchanged_by;
+
   SPIRV_TIMER_DESCRIPTION(time_report_stream_, /* measure_mem_usage = */ true);
   for (auto& pass : passes_) {
+    if (skip_unchanged_passes_ && unchanged_by.count(pass->name())) {
+      pass.reset(nullptr);
+      continue;
+    }
+
     print_disassembly("; IR before pass ", pass.get());
     SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""), true);
     const auto one_status = pass->Run(context);
     if (one_status == Pass::Status::Failure) return one_status;
     if (one_status == Pass::Status::SuccessWithChange) status = one_status;
+    if (skip_unchanged_passes_) {
+      // A pass that made a change may find more to change if it runs again.
+      if (one_status == Pass::Status::SuccessWithChange) {
+        unchanged_by.clear();
+      } else if (pass->IsIdentifiedByName()) {
+        unchanged_by.insert(pass->name());
+      }
+    }
 
     if (validate_after_all_) {
       spvtools::SpirvTools tools(target_env_);
@@ -46,7 +46,8 @@ class PassManager {
         time_report_stream_(nullptr),
         target_env_(SPV_ENV_UNIVERSAL_1_2),
         val_options_(nullptr),
-        validate_after_all_(false) {}
+        validate_after_all_(false),
+        skip_unchanged_passes_(false) {}
 
   // Sets the message consumer to the given |consumer|.
   void SetMessageConsumer(MessageConsumer c) { consumer_ = std::move(c); }
@@ -61,6 +62,8 @@ class PassManager {
 
   // Returns the number of passes added.
   uint32_t NumPasses() const;
+  // Removes all passes added, as a run does.
+  void ClearPasses() { passes_.clear(); }
   // Returns a pointer to the |index|th pass added.
   inline Pass* GetPass(uint32_t index) const;
 
@@ -110,6 +113,16 @@ class PassManager {
     return *this;
   }
 
+  // Sets the option to skip a pass when a pass with the same name already ran
+  // without changing the module, and no pass changed the module since.  Passes
+  // are deterministic, so running it again could not change anything either.
+  // Passes that are not identified by their name always run.  Skipped passes
+  // are not printed or timed.
+  PassManager& SetSkipUnchangedPasses(bool skip) {
+    skip_unchanged_passes_ = skip;
+    return *this;
+  }
+
  private:
   // Consumer for messages.
   MessageConsumer consumer_;
@@ -127,6 +140,8 @@ class PassManager {
   spv_validator_options val_options_;
   // Controls whether validation occurs after every pass.
   bool validate_after_all_;
+  // Controls whether passes that cannot change the module are skipped.
+  bool skip_unchanged_passes_;
 };
 
 inline void PassManager::AddPass(std::unique_ptr<Pass> pass) {
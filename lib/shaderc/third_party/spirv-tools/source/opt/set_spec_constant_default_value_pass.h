@@ -58,6 +58,7 @@ class SetSpecConstantDefaultValuePass : public Pass {
         spec_id_to_value_bit_pattern_(std::move(default_values)) {}
 
   const char* name() const override { return "set-spec-const-default-value"; }
+  bool IsIdentifiedByName() const override { return false; }
   Status Process() override;
 
   // Parses the given null-terminated C string to get a mapping from Spec Id to
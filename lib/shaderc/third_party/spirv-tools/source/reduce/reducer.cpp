@@ -14,8 +14,10 @@
 
 #include "source/reduce/reducer.h"
 
+#include <atomic>
 #include <cassert>
 #include <sstream>
+#include <thread>
 
 #include "source/reduce/conditional_branch_to_simple_conditional_branch_opportunity_finder.h"
 #include "source/reduce/merge_blocks_reduction_opportunity_finder.h"
@@ -183,6 +185,19 @@ Reducer::ReductionResultStatus Reducer::RunPasses(
       consumer_(SPV_MSG_INFO, nullptr, {},
                 ("Trying pass " + pass->GetName() + ".").c_str());
       do {
+        if (options->parallel_candidates > 1) {
+          bool state_invalid = false;
+          if (!TryReductionStepsInParallel(
+                  pass.get(), options, validator_options, tools,
+                  current_binary, reductions_applied,
+                  &another_round_worthwhile, &state_invalid)) {
+            if (state_invalid) {
+              return Reducer::ReductionResultStatus::kStateInvalid;
+            }
+            break;
+          }
+          continue;
+        }
         auto maybe_result =
             pass->TryApplyReduction(*current_binary, options->target_function);
         if (maybe_result.empty()) {
@@ -242,5 +257,87 @@ Reducer::ReductionResultStatus Reducer::RunPasses(
   return Reducer::ReductionResultStatus::kComplete;
 }
 
+bool Reducer::TryReductionStepsInParallel(
+    ReductionPass* pass, spv_const_reducer_options options,
+    spv_validator_options validator_options, const SpirvTools& tools,
+    std::vector<uint32_t>* current_binary, uint32_t* reductions_applied,
+    bool* another_round_worthwhile, bool* state_invalid) {
+  *state_invalid = false;
+  std::vector<std::vector<uint32_t>> candidates = pass->TryApplyReductions(
+      *current_binary, options->target_function,
+      std::min(options->parallel_candidates,
+               options->step_limit - *reductions_applied));
+  if (candidates.empty()) {
+    consumer_(SPV_MSG_INFO, nullptr, {},
+              ("Pass " + pass->GetName() + " did not make a reduction step.")
+                  .c_str());
+    return false;
+  }
+
+  // Only the candidates up to the first one that is interesting, or that
+  // stops the reduction, matter; the others are skipped once it is known.
+  enum Outcome : char { kNotTried, kUninteresting, kInteresting, kInvalid };
+  const size_t num_candidates = candidates.size();
+  std::vector<Outcome> outcomes(num_candidates, kNotTried);
+  std::atomic<size_t> next_candidate(0);
+  std::atomic<size_t> first_decisive(num_candidates);
+  auto work = [&]() {
+    for (size_t i = next_candidate++; i < num_candidates;
+         i = next_candidate++) {
+      if (i > first_decisive) continue;
+      bool decisive = false;
+      if (!tools.Validate(candidates[i].data(), candidates[i].size(),
+                          validator_options)) {
+        outcomes[i] = kInvalid;
+        decisive = options->fail_on_validation_error;
+      } else if (interestingness_function_(
+                     candidates[i],
+                     *reductions_applied + static_cast<uint32_t>(i) + 1)) {
+        outcomes[i] = kInteresting;
+        decisive = true;
+      } else {
+        outcomes[i] = kUninteresting;
+      }
+      size_t first = first_decisive;
+      while (decisive && i < first &&
+             !first_decisive.compare_exchange_weak(first, i)) {
+      }
+    }
+  };
+  const size_t num_threads =
+      std::min<size_t>(std::thread::hardware_concurrency(), num_candidates);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; ++i) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+
+  // Report the candidates in order, as if they had been tried one at a time.
+  for (size_t i = 0; i < num_candidates; ++i) {
+    assert(outcomes[i] != kNotTried);
+    std::stringstream stringstream;
+    (*reductions_applied)++;
+    stringstream << "Pass " << pass->GetName() << " made reduction step "
+                 << *reductions_applied << ".";
+    consumer_(SPV_MSG_INFO, nullptr, {}, (stringstream.str().c_str()));
+    if (outcomes[i] == kInvalid) {
+      consumer_(SPV_MSG_INFO, nullptr, {},
+                "Reduction step produced an invalid binary.");
+      if (options->fail_on_validation_error) {
+        *current_binary = std::move(candidates[i]);
+        *state_invalid = true;
+        return false;
+      }
+    } else if (outcomes[i] == kInteresting) {
+      consumer_(SPV_MSG_INFO, nullptr, {}, "Reduction step succeeded.");
+      *current_binary = std::move(candidates[i]);
+      *another_round_worthwhile = true;
+      pass->NotifyUninteresting(static_cast<uint32_t>(i));
+      return true;
+    }
+  }
+  pass->NotifyUninteresting(static_cast<uint32_t>(num_candidates));
+  return true;
+}
+
 }  // namespace reduce
 }  // namespace spvtools
@@ -109,6 +109,22 @@ class Reducer {
       spv_validator_options validator_options, const SpirvTools& tools,
       std::vector<uint32_t>* current_binary, uint32_t* reductions_applied);
 
+  // Tries up to |options->parallel_candidates| reduction steps of |pass| at
+  // once, and keeps the first interesting one in |current_binary|.  The steps
+  // are counted and reported as if they had been tried one at a time, up to
+  // the one that was kept.  Returns false if |pass| has no chunks left in this
+  // round, or if a step failed validation and |options| asks to fail then;
+  // |state_invalid| is set in the latter case, with the invalid binary in
+  // |current_binary|.
+  bool TryReductionStepsInParallel(ReductionPass* pass,
+                                   spv_const_reducer_options options,
+                                   spv_validator_options validator_options,
+                                   const SpirvTools& tools,
+                                   std::vector<uint32_t>* current_binary,
+                                   uint32_t* reductions_applied,
+                                   bool* another_round_worthwhile,
+                                   bool* state_invalid);
+
   const spv_target_env target_env_;
   MessageConsumer consumer_;
   InterestingnessFunction interestingness_function_;
@@ -23,6 +23,40 @@ namespace reduce {
 
 std::vector<uint32_t> ReductionPass::TryApplyReduction(
     const std::vector<uint32_t>& binary, uint32_t target_function) {
+  std::vector<uint32_t> result;
+  if (!ApplyChunk(binary, target_function, index_, &result)) {
+    // We have reached the end of the available opportunities and, therefore,
+    // the end of the round for this pass, so reset the index and decrease the
+    // granularity for the next round. Return an empty vector to signal the end
+    // of the round.
+    index_ = 0;
+    granularity_ = std::max((uint32_t)1, granularity_ / 2);
+  }
+  return result;
+}
+
+std::vector<std::vector<uint32_t>> ReductionPass::TryApplyReductions(
+    const std::vector<uint32_t>& binary, uint32_t target_function,
+    uint32_t max_candidates) {
+  std::vector<std::vector<uint32_t>> candidates;
+  std::vector<uint32_t> candidate = TryApplyReduction(binary, target_function);
+  while (!candidate.empty()) {
+    candidates.push_back(std::move(candidate));
+    if (candidates.size() >= max_candidates) break;
+    // The granularity is fixed by the first chunk, so the next chunk starts
+    // where the one before it ended.
+    if (!ApplyChunk(binary, target_function,
+                    index_ + (uint32_t)candidates.size() * granularity_,
+                    &candidate)) {
+      break;
+    }
+  }
+  return candidates;
+}
+
+bool ReductionPass::ApplyChunk(const std::vector<uint32_t>& binary,
+                               uint32_t target_function, uint32_t index,
+                               std::vector<uint32_t>* result) {
   // We represent modules as binaries because (a) attempts at reduction need to
   // end up in binary form to be passed on to SPIR-V-consuming tools, and (b)
   // when we apply a reduction step we need to do it on a fresh version of the
@@ -44,25 +78,19 @@ std::vector<uint32_t> ReductionPass::TryApplyReduction(
 
   assert(granularity_ > 0);
 
-  if (index_ >= opportunities.size()) {
-    // We have reached the end of the available opportunities and, therefore,
-    // the end of the round for this pass, so reset the index and decrease the
-    // granularity for the next round. Return an empty vector to signal the end
-    // of the round.
-    index_ = 0;
-    granularity_ = std::max((uint32_t)1, granularity_ / 2);
-    return std::vector<uint32_t>();
+  if (index >= opportunities.size()) {
+    return false;
   }
 
-  for (uint32_t i = index_;
-       i < std::min(index_ + granularity_, (uint32_t)opportunities.size());
+  for (uint32_t i = index;
+       i < std::min(index + granularity_, (uint32_t)opportunities.size());
        ++i) {
     opportunities[i]->TryToApply();
   }
 
-  std::vector<uint32_t> result;
-  context->module()->ToBinary(&result, false);
-  return result;
+  result->clear();
+  context->module()->ToBinary(result, false);
+  return true;
 }
 
 void ReductionPass::SetMessageConsumer(MessageConsumer consumer) {
@@ -82,5 +110,9 @@ void ReductionPass::NotifyInteresting(bool interesting) {
   }
 }
 
+void ReductionPass::NotifyUninteresting(uint32_t count) {
+  index_ += count * granularity_;
+}
+
 }  // namespace reduce
 }  // namespace spvtools
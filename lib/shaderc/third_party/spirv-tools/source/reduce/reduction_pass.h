@@ -56,11 +56,26 @@ class ReductionPass {
   std::vector<uint32_t> TryApplyReduction(const std::vector<uint32_t>& binary,
                                           uint32_t target_function);
 
+  // Like TryApplyReduction, but returns up to |max_candidates| binaries: the
+  // first has the chunk TryApplyReduction would apply, and each of the others
+  // has the chunk after that of the binary before it.  Each chunk is applied to
+  // |binary| on its own.  If any binaries are returned, before the next call
+  // the caller must invoke NotifyUninteresting(...) with the number of leading
+  // binaries that were not interesting.
+  std::vector<std::vector<uint32_t>> TryApplyReductions(
+      const std::vector<uint32_t>& binary, uint32_t target_function,
+      uint32_t max_candidates);
+
   // Notifies the reduction pass whether the binary returned from
   // TryApplyReduction is interesting, so that the next call to
   // TryApplyReduction will avoid applying the same chunk of opportunities.
   void NotifyInteresting(bool interesting);
 
+  // Notifies the reduction pass that the first |count| binaries returned from
+  // TryApplyReductions were not interesting, so that the next call will start
+  // from the chunk after them.
+  void NotifyUninteresting(uint32_t count);
+
   // Sets a consumer to which relevant messages will be directed.
   void SetMessageConsumer(MessageConsumer consumer);
 
@@ -73,6 +88,12 @@ class ReductionPass {
   std::string GetName() const;
 
  private:
+  // Applies the chunk of opportunities starting at |index| to a fresh copy of
+  // |binary|, and stores the resulting binary in |result|.  Returns false if
+  // there are no opportunities from |index| on.
+  bool ApplyChunk(const std::vector<uint32_t>& binary, uint32_t target_function,
+                  uint32_t index, std::vector<uint32_t>* result);
+
   const spv_target_env target_env_;
   const std::unique_ptr<ReductionOpportunityFinder> finder_;
   MessageConsumer consumer_;
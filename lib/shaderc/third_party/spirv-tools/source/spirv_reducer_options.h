@@ -33,6 +33,9 @@ struct spv_reducer_options_t {
 
   // See spvReducerOptionsSetTargetFunction.
   uint32_t target_function;
+
+  // See spvReducerOptionsSetParallelCandidates.
+  uint32_t parallel_candidates;
 };
 
 #endif  // SOURCE_SPIRV_REDUCER_OPTIONS_H_
@@ -120,3 +120,7 @@ void spvValidatorOptionsSetSkipBlockLayout(spv_validator_options options,
                                            bool val) {
   options->skip_block_layout = val;
 }
+
+void spvValidatorOptionsSetParallel(spv_validator_options options, bool val) {
+  options->parallel = val;
+}
@@ -47,7 +47,8 @@ struct spv_validator_options_t {
         scalar_block_layout(false),
         workgroup_scalar_block_layout(false),
         skip_block_layout(false),
-        before_hlsl_legalization(false) {}
+        before_hlsl_legalization(false),
+        parallel(false) {}
 
   validator_universal_limits_t universal_limits_;
   bool relax_struct_store;
@@ -58,6 +59,7 @@ struct spv_validator_options_t {
   bool workgroup_scalar_block_layout;
   bool skip_block_layout;
   bool before_hlsl_legalization;
+  bool parallel;
 };
 
 #endif  // SOURCE_SPIRV_VALIDATOR_OPTIONS_H_
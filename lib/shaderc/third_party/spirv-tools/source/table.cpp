@@ -14,8 +14,89 @@
 
 #include "source/table.h"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 
+#include "source/opcode.h"
+#include "source/operand.h"
+#include "source/util/make_unique.h"
+
+namespace {
+
+// Operand values at or above this are left to the searching lookup. Every value
+// enumeration in the grammar fits below it; only a few bit masks do not.
+const uint32_t kMaxIndexedOperandValue = 0x4000;
+
+// Resolves every opcode and operand value in the tables for env through the
+// searching lookups, so the index gives exactly the same answers.
+std::unique_ptr<spv_grammar_index_t> BuildGrammarIndex(spv_target_env env) {
+  spv_opcode_table opcode_table;
+  spv_operand_table operand_table;
+  spvOpcodeTableGet(&opcode_table, env);
+  spvOperandTableGet(&operand_table, env);
+
+  auto index = spvtools::MakeUnique<spv_grammar_index_t>();
+
+  uint32_t max_opcode = 0;
+  for (uint32_t i = 0; i < opcode_table->count; ++i) {
+    const auto opcode = static_cast<uint32_t>(opcode_table->entries[i].opcode);
+    max_opcode = std::max(max_opcode, opcode);
+  }
+  index->opcodes.assign(max_opcode + 1, nullptr);
+  for (uint32_t i = 0; i < opcode_table->count; ++i) {
+    const SpvOp opcode = opcode_table->entries[i].opcode;
+    auto& slot = index->opcodes[opcode];
+    if (slot) continue;
+    spv_opcode_desc desc = nullptr;
+    if (spvOpcodeTableValueLookup(env, opcode_table, opcode, &desc) ==
+        SPV_SUCCESS) {
+      slot = desc;
+    }
+  }
+
+  index->operands.assign(SPV_OPERAND_TYPE_NUM_OPERAND_TYPES,
+                         spv_grammar_index_t::operand_values_t{{}, true});
+  for (uint32_t i = 0; i < operand_table->count; ++i) {
+    const auto& group = operand_table->types[i];
+    if (group.type >= SPV_OPERAND_TYPE_NUM_OPERAND_TYPES) continue;
+    auto& values = index->operands[group.type];
+    for (uint32_t j = 0; j < group.count; ++j) {
+      const uint32_t value = group.entries[j].value;
+      if (value >= kMaxIndexedOperandValue) {
+        values.complete = false;
+        continue;
+      }
+      if (value >= values.entries.size()) {
+        values.entries.resize(value + 1, nullptr);
+      }
+      auto& slot = values.entries[value];
+      if (slot) continue;
+      spv_operand_desc desc = nullptr;
+      if (spvOperandTableValueLookup(env, operand_table, group.type, value,
+                                     &desc) == SPV_SUCCESS) {
+        slot = desc;
+      }
+    }
+  }
+
+  return index;
+}
+
+}  // namespace
+
+spv_grammar_index spvGrammarIndexGet(spv_target_env env) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::unique_ptr<spv_grammar_index_t>> indices;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& index = indices[static_cast<int>(env)];
+  if (!index) index = BuildGrammarIndex(env);
+  return index.get();
+}
+
 spv_context spvContextCreate(spv_target_env env) {
   switch (env) {
     case SPV_ENV_UNIVERSAL_1_0:
@@ -54,8 +135,12 @@ spv_context spvContextCreate(spv_target_env env) {
   spvOperandTableGet(&operand_table, env);
   spvExtInstTableGet(&ext_inst_table, env);
 
-  return new spv_context_t{env, opcode_table, operand_table, ext_inst_table,
-                           nullptr /* a null default consumer */};
+  return new spv_context_t{env,
+                           opcode_table,
+                           operand_table,
+                           ext_inst_table,
+                           nullptr /* a null default consumer */,
+                           spvGrammarIndexGet(env)};
 }
 
 void spvContextDestroy(spv_context context) { delete context; }
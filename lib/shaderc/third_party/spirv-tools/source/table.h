@@ -15,6 +15,8 @@
 #ifndef SOURCE_TABLE_H_
 #define SOURCE_TABLE_H_
 
+#include <vector>
+
 #include "source/extensions.h"
 #include "source/latest_version_spirv_header.h"
 #include "spirv-tools/libspirv.hpp"
@@ -106,12 +108,33 @@ typedef const spv_opcode_table_t* spv_opcode_table;
 typedef const spv_operand_table_t* spv_operand_table;
 typedef const spv_ext_inst_table_t* spv_ext_inst_table;
 
+// Opcode and operand value lookups resolved against one target environment.
+// Entries are indexed directly by their numeric value, so a lookup is a bounds
+// check and a load rather than a binary search followed by a version filter.
+// A null entry means the value is not available in the environment.
+typedef struct spv_grammar_index_t {
+  typedef struct operand_values_t {
+    std::vector<spv_operand_desc> entries;
+    // False if the type has values too large to index directly. Values past
+    // the end of |entries| must then be looked up in the operand table.
+    bool complete;
+  } operand_values_t;
+
+  std::vector<spv_opcode_desc> opcodes;
+  // Indexed by spv_operand_type_t.
+  std::vector<operand_values_t> operands;
+} spv_grammar_index_t;
+
+typedef const spv_grammar_index_t* spv_grammar_index;
+
 struct spv_context_t {
   const spv_target_env target_env;
   const spv_opcode_table opcode_table;
   const spv_operand_table operand_table;
   const spv_ext_inst_table ext_inst_table;
   spvtools::MessageConsumer consumer;
+  // Shared by every context created for the same target environment.
+  spv_grammar_index grammar_index;
 };
 
 namespace spvtools {
@@ -121,6 +144,10 @@ namespace spvtools {
 void SetContextMessageConsumer(spv_context context, MessageConsumer consumer);
 }  // namespace spvtools
 
+// Returns the direct lookup index for env, building it on first use. The index
+// lives for the rest of the process. Thread safe.
+spv_grammar_index spvGrammarIndexGet(spv_target_env env);
+
 // Populates *table with entries for env.
 spv_result_t spvOpcodeTableGet(spv_opcode_table* table, spv_target_env env);
 
@@ -577,6 +577,8 @@ spv_result_t spvTextEncodeOpcode(const spvtools::AssemblyGrammar& grammar,
   }
   pInst->opcode = opcodeEntry->opcode;
   context->setPosition(nextPosition);
+  // Most operands take one word, so this usually avoids growing the vector.
+  pInst->words.reserve(1 + opcodeEntry->numTypes);
   // Reserve the first word for the instruction.
   spvInstructionAddWord(pInst, 0);
 
@@ -593,6 +595,8 @@ spv_result_t spvTextEncodeOpcode(const spvtools::AssemblyGrammar& grammar,
     expectedOperands.push_back(
         opcodeEntry->operandTypes[opcodeEntry->numTypes - i - 1]);
 
+  // Reused for every operand so long words only allocate once.
+  std::string operandValue;
   while (!expectedOperands.empty()) {
     const spv_operand_type_t type = expectedOperands.back();
     expectedOperands.pop_back();
@@ -636,7 +640,6 @@ spv_result_t spvTextEncodeOpcode(const spvtools::AssemblyGrammar& grammar,
         }
       }
 
-      std::string operandValue;
       error = context->getWord(&operandValue, &nextPosition);
       if (error) return context->diagnostic(error) << "Internal Error";
 
@@ -755,6 +758,8 @@ spv_result_t spvTextToBinaryInternal(const spvtools::AssemblyGrammar& grammar,
   if (!pBinary) return SPV_ERROR_INVALID_POINTER;
 
   std::vector<spv_instruction_t> instructions;
+  instructions.reserve(
+      spvtools::AssemblyContext::EstimateInstructionCount(text));
 
   // Skip past whitespace and comments.
   context.advance();
@@ -61,51 +61,45 @@ spv_result_t advanceLine(spv_text text, spv_position position) {
 // parameters, its the users responsibility to ensure these are non null.
 spv_result_t advance(spv_text text, spv_position position) {
   // NOTE: Consume white space, otherwise don't advance.
-  if (position->index >= text->length) return SPV_END_OF_STREAM;
-  switch (text->str[position->index]) {
-    case '\0':
-      return SPV_END_OF_STREAM;
-    case ';':
-      if (spv_result_t error = advanceLine(text, position)) return error;
-      return advance(text, position);
-    case ' ':
-    case '\t':
-    case '\r':
-      position->column++;
-      position->index++;
-      return advance(text, position);
-    case '\n':
-      position->column = 0;
-      position->line++;
-      position->index++;
-      return advance(text, position);
-    default:
-      break;
+  while (true) {
+    if (position->index >= text->length) return SPV_END_OF_STREAM;
+    switch (text->str[position->index]) {
+      case '\0':
+        return SPV_END_OF_STREAM;
+      case ';':
+        if (spv_result_t error = advanceLine(text, position)) return error;
+        break;
+      case ' ':
+      case '\t':
+      case '\r':
+        position->column++;
+        position->index++;
+        break;
+      case '\n':
+        position->column = 0;
+        position->line++;
+        position->index++;
+        break;
+      default:
+        return SPV_SUCCESS;
+    }
   }
-  return SPV_SUCCESS;
 }
 
-// Fetches the next word from the given text stream starting from the given
-// *position. On success, writes the decoded word into *word and updates
-// *position to the location past the returned word.
+// Moves *position past the word starting there, without copying it out.
 //
 // A word ends at the next comment or whitespace.  However, double-quoted
 // strings remain intact, and a backslash always escapes the next character.
-spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
+spv_result_t skipWord(spv_text text, spv_position position) {
   if (!text->str || !text->length) return SPV_ERROR_INVALID_TEXT;
   if (!position) return SPV_ERROR_INVALID_POINTER;
 
-  const size_t start_index = position->index;
-
   bool quoting = false;
   bool escaping = false;
 
   // NOTE: Assumes first character is not white space!
   while (true) {
-    if (position->index >= text->length) {
-      word->assign(text->str + start_index, text->str + position->index);
-      return SPV_SUCCESS;
-    }
+    if (position->index >= text->length) return SPV_SUCCESS;
     const char ch = text->str[position->index];
     if (ch == '\\') {
       escaping = !escaping;
@@ -121,10 +115,8 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
         case '\r':
           if (escaping || quoting) break;
         // Fall through.
-        case '\0': {  // NOTE: End of word found!
-          word->assign(text->str + start_index, text->str + position->index);
+        case '\0':  // NOTE: End of word found!
           return SPV_SUCCESS;
-        }
         default:
           break;
       }
@@ -136,6 +128,17 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
   }
 }
 
+// Fetches the next word from the given text stream starting from the given
+// *position. On success, writes the decoded word into *word and updates
+// *position to the location past the returned word.
+spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
+  if (!position) return SPV_ERROR_INVALID_POINTER;
+  const size_t start_index = position->index;
+  if (spv_result_t error = skipWord(text, position)) return error;
+  word->assign(text->str + start_index, text->str + position->index);
+  return SPV_SUCCESS;
+}
+
 // Returns true if the characters in the text as position represent
 // the start of an Opcode.
 bool startsWithOp(spv_text text, spv_position position) {
@@ -150,6 +153,85 @@ bool startsWithOp(spv_text text, spv_position position) {
 
 const IdType kUnknownType = {0, false, IdTypeClass::kBottom};
 
+namespace {
+
+// Names are copied into blocks of at least this many characters.
+const size_t kNameBlockSize = 64 * 1024;
+
+size_t HashName(const char* name, size_t length) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ull;
+  }
+  return static_cast<size_t>(hash);
+}
+
+}  // namespace
+
+NamedIdTable::NamedIdTable(size_t expected_names)
+    : num_entries_(0), block_next_(nullptr), block_left_(0) {
+  // Keep the table at most half full.
+  size_t num_slots = 16;
+  while (num_slots < expected_names * 2) num_slots *= 2;
+  slots_.assign(num_slots, Entry{nullptr, 0, 0, 0});
+}
+
+size_t NamedIdTable::Probe(const char* name, size_t length,
+                           size_t hash) const {
+  const size_t mask = slots_.size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    const Entry& entry = slots_[slot];
+    if (!entry.name) return slot;
+    if (entry.hash == hash && entry.length == length &&
+        !memcmp(entry.name, name, length)) {
+      return slot;
+    }
+  }
+}
+
+bool NamedIdTable::Find(const char* name, size_t length, uint32_t* id) const {
+  const Entry& entry = slots_[Probe(name, length, HashName(name, length))];
+  if (!entry.name) return false;
+  *id = entry.id;
+  return true;
+}
+
+void NamedIdTable::Insert(const char* name, size_t length, uint32_t id) {
+  if ((num_entries_ + 1) * 2 > slots_.size()) Grow();
+  const size_t hash = HashName(name, length);
+  Entry& entry = slots_[Probe(name, length, hash)];
+  assert(!entry.name && "Name is already in the table");
+  entry = Entry{CopyName(name, length), length, hash, id};
+  ++num_entries_;
+}
+
+const char* NamedIdTable::CopyName(const char* name, size_t length) {
+  if (length + 1 > block_left_) {
+    const size_t block_size = std::max(kNameBlockSize, length + 1);
+    blocks_.emplace_back(new char[block_size]);
+    block_next_ = blocks_.back().get();
+    block_left_ = block_size;
+  }
+  char* copy = block_next_;
+  memcpy(copy, name, length);
+  copy[length] = '\0';
+  block_next_ += length + 1;
+  block_left_ -= length + 1;
+  return copy;
+}
+
+void NamedIdTable::Grow() {
+  std::vector<Entry> old_slots(slots_.size() * 2, Entry{nullptr, 0, 0, 0});
+  old_slots.swap(slots_);
+  const size_t mask = slots_.size() - 1;
+  for (const Entry& entry : old_slots) {
+    if (!entry.name) continue;
+    size_t slot = entry.hash & mask;
+    while (slots_[slot].name) slot = (slot + 1) & mask;
+    slots_[slot] = entry;
+  }
+}
+
 // TODO(dneto): Reorder AssemblyContext definitions to match declaration order.
 
 // This represents all of the data that is only valid for the duration of
@@ -165,21 +247,20 @@ uint32_t AssemblyContext::spvNamedIdAssignOrGet(const char* textValue) {
     }
   }
 
-  const auto it = named_ids_.find(textValue);
-  if (it == named_ids_.end()) {
-    uint32_t id = next_id_++;
-    if (!ids_to_preserve_.empty()) {
-      while (ids_to_preserve_.find(id) != ids_to_preserve_.end()) {
-        id = next_id_++;
-      }
-    }
+  const size_t length = strlen(textValue);
+  uint32_t id = 0;
+  if (named_ids_.Find(textValue, length, &id)) return id;
 
-    named_ids_.emplace(textValue, id);
-    bound_ = std::max(bound_, id + 1);
-    return id;
+  id = next_id_++;
+  if (!ids_to_preserve_.empty()) {
+    while (ids_to_preserve_.find(id) != ids_to_preserve_.end()) {
+      id = next_id_++;
+    }
   }
 
-  return it->second;
+  named_ids_.Insert(textValue, length, id);
+  bound_ = std::max(bound_, id + 1);
+  return id;
 }
 
 uint32_t AssemblyContext::getBound() const { return bound_; }
@@ -203,14 +284,17 @@ bool AssemblyContext::isStartOfNewInst() {
   if (spvtools::advance(text_, &pos)) return false;
   if (spvtools::startsWithOp(text_, &pos)) return true;
 
-  std::string word;
+  // Look for "%name =" in place rather than copying out either word.
   pos = current_position_;
-  if (spvtools::getWord(text_, &pos, &word)) return false;
-  if ('%' != word.front()) return false;
+  if (pos.index >= text_->length || '%' != text_->str[pos.index]) return false;
+  if (spvtools::skipWord(text_, &pos)) return false;
 
   if (spvtools::advance(text_, &pos)) return false;
-  if (spvtools::getWord(text_, &pos, &word)) return false;
-  if ("=" != word) return false;
+  const size_t equal_sign = pos.index;
+  if (spvtools::skipWord(text_, &pos)) return false;
+  if (pos.index != equal_sign + 1 || '=' != text_->str[equal_sign]) {
+    return false;
+  }
 
   if (spvtools::advance(text_, &pos)) return false;
   if (spvtools::startsWithOp(text_, &pos)) return true;
@@ -387,10 +471,10 @@ spv_ext_inst_type_t AssemblyContext::getExtInstTypeForId(uint32_t id) const {
 
 std::set<uint32_t> AssemblyContext::GetNumericIds() const {
   std::set<uint32_t> ids;
-  for (const auto& kv : named_ids_) {
+  named_ids_.ForEach([&ids](const char* name, uint32_t) {
     uint32_t id;
-    if (spvtools::utils::ParseNumber(kv.first.c_str(), &id)) ids.insert(id);
-  }
+    if (spvtools::utils::ParseNumber(name, &id)) ids.insert(id);
+  });
   return ids;
 }
 
@@ -16,12 +16,14 @@
 #define SOURCE_TEXT_HANDLER_H_
 
 #include <iomanip>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "source/diagnostic.h"
 #include "source/instruction.h"
@@ -117,22 +119,80 @@ class ClampToZeroIfUnsignedType<
   }
 };
 
+// Maps ID names to their numerical ids.  Names are copied into large blocks
+// owned by the table, so adding one costs no allocation of its own, and a
+// lookup takes the name as it appears in the text without building a string.
+class NamedIdTable {
+ public:
+  // Creates a table with room for |expected_names| names before it grows.
+  explicit NamedIdTable(size_t expected_names);
+
+  // Returns true and sets |id| if |name| of |length| characters is in the
+  // table.
+  bool Find(const char* name, size_t length, uint32_t* id) const;
+
+  // Adds |name| of |length| characters with the given |id|.  The name must not
+  // be in the table yet.
+  void Insert(const char* name, size_t length, uint32_t id);
+
+  // Calls |f| with the null-terminated name and the id of every entry.
+  template <typename F>
+  void ForEach(F f) const {
+    for (const Entry& entry : slots_) {
+      if (entry.name) f(entry.name, entry.id);
+    }
+  }
+
+ private:
+  struct Entry {
+    const char* name;
+    size_t length;
+    size_t hash;
+    uint32_t id;
+  };
+
+  // Returns the slot holding |name|, or the empty slot where it would go.
+  size_t Probe(const char* name, size_t length, size_t hash) const;
+
+  // Returns a null-terminated copy of |name| in the name blocks.
+  const char* CopyName(const char* name, size_t length);
+
+  // Doubles the number of slots.
+  void Grow();
+
+  // Open addressing with linear probing.  The size is a power of two.
+  std::vector<Entry> slots_;
+  size_t num_entries_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* block_next_;
+  size_t block_left_;
+};
+
 // Encapsulates the data used during the assembly of a SPIR-V module.
 class AssemblyContext {
  public:
   AssemblyContext(spv_text text, const MessageConsumer& consumer,
                   std::set<uint32_t>&& ids_to_preserve = std::set<uint32_t>())
-      : current_position_({}),
+      : named_ids_(text ? text->length / kTextPerNamedId : 0),
+        current_position_({}),
         consumer_(consumer),
         text_(text),
         bound_(1),
         next_id_(1),
-        ids_to_preserve_(std::move(ids_to_preserve)) {}
+        ids_to_preserve_(std::move(ids_to_preserve)) {
+    value_types_.reserve(EstimateInstructionCount(text));
+  }
 
   // Assigns a new integer value to the given text ID, or returns the previously
   // assigned integer value if the ID has been seen before.
   uint32_t spvNamedIdAssignOrGet(const char* textValue);
 
+  // Returns the number of instructions |text| is expected to hold, for sizing
+  // containers up front.
+  static size_t EstimateInstructionCount(const spv_text text) {
+    return text ? text->length / kTextPerInstruction : 0;
+  }
+
   // Returns the largest largest numeric ID that has been assigned.
   uint32_t getBound() const;
 
@@ -239,14 +299,18 @@ class AssemblyContext {
   std::set<uint32_t> GetNumericIds() const;
 
  private:
-  // Maps ID names to their corresponding numerical ids.
-  using spv_named_id_table = std::unordered_map<std::string, uint32_t>;
+  // Rough number of characters of assembly per instruction and per named id,
+  // used to size the tables from the length of the text.  Too small an
+  // estimate only costs a rehash.
+  static const size_t kTextPerInstruction = 32;
+  static const size_t kTextPerNamedId = 64;
+
   // Maps type-defining IDs to their IdType.
   using spv_id_to_type_map = std::unordered_map<uint32_t, IdType>;
   // Maps Ids to the id of their type.
   using spv_id_to_type_id = std::unordered_map<uint32_t, uint32_t>;
 
-  spv_named_id_table named_ids_;
+  NamedIdTable named_ids_;
   spv_id_to_type_map types_;
   spv_id_to_type_id value_types_;
   // Maps an extended instruction import Id to the extended instruction type.
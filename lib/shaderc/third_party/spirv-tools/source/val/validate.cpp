@@ -15,6 +15,7 @@
 #include "source/val/validate.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <functional>
@@ -22,6 +23,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "source/binary.h"
@@ -151,6 +153,271 @@ spv_result_t ValidateEntryPoints(ValidationState_t& _) {
   return SPV_SUCCESS;
 }
 
+// A pass that checks single instructions.
+typedef spv_result_t (*InstructionPassFn)(ValidationState_t& _,
+                                          const Instruction* inst);
+
+bool GeneratesType(SpvOp opcode) { return spvOpcodeGeneratesType(opcode); }
+bool IsConstant(SpvOp opcode) { return spvOpcodeIsConstant(opcode); }
+
+// An instruction pass and the opcodes it does anything for.
+struct PassOpcodes {
+  InstructionPassFn pass;
+  // If set, the pass handles the opcodes it accepts as well.
+  bool (*handles)(SpvOp opcode);
+  // The opcodes the pass handles.  Keep these in sync with the switches in the
+  // passes, since a pass never sees an opcode missing here.
+  std::vector<SpvOp> opcodes;
+};
+
+// Returns every instruction pass, in the order they run.
+const std::vector<PassOpcodes>& AllInstructionPasses() {
+  // Keep these passes in the order they appear in the SPIR-V specification
+  // sections to maintain test consistency.
+  static const std::vector<PassOpcodes> passes = {
+    {MiscPass, nullptr,
+     {SpvOpBeginInvocationInterlockEXT, SpvOpDemoteToHelperInvocationEXT,
+      SpvOpEndInvocationInterlockEXT, SpvOpIsHelperInvocationEXT,
+      SpvOpReadClockKHR, SpvOpUndef}},
+    {DebugPass, nullptr, {SpvOpLine, SpvOpMemberName}},
+    {AnnotationPass, nullptr,
+     {SpvOpDecorate, SpvOpDecorateId, SpvOpDecorationGroup,
+      SpvOpGroupDecorate, SpvOpGroupMemberDecorate, SpvOpMemberDecorate}},
+    {ExtensionPass, nullptr,
+     {SpvOpExtension, SpvOpExtInstImport, SpvOpExtInst}},
+    {ModeSettingPass, nullptr,
+     {SpvOpEntryPoint, SpvOpExecutionMode, SpvOpExecutionModeId,
+      SpvOpMemoryModel}},
+    {TypePass, GeneratesType, {SpvOpTypeForwardPointer}},
+    {ConstantPass, IsConstant,
+     {SpvOpConstantComposite, SpvOpConstantFalse, SpvOpConstantNull,
+      SpvOpConstantSampler, SpvOpConstantTrue, SpvOpSpecConstant,
+      SpvOpSpecConstantComposite, SpvOpSpecConstantFalse, SpvOpSpecConstantOp,
+      SpvOpSpecConstantTrue}},
+    {MemoryPass, nullptr,
+     {SpvOpAccessChain, SpvOpArrayLength, SpvOpCooperativeMatrixLengthNV,
+      SpvOpCooperativeMatrixLoadNV, SpvOpCooperativeMatrixStoreNV,
+      SpvOpCopyMemory, SpvOpCopyMemorySized, SpvOpGenericPtrMemSemantics,
+      SpvOpImageTexelPointer, SpvOpInBoundsAccessChain,
+      SpvOpInBoundsPtrAccessChain, SpvOpLoad, SpvOpPtrAccessChain,
+      SpvOpPtrDiff, SpvOpPtrEqual, SpvOpPtrNotEqual, SpvOpStore,
+      SpvOpVariable}},
+    {FunctionPass, nullptr,
+     {SpvOpFunction, SpvOpFunctionCall, SpvOpFunctionParameter}},
+    {ImagePass, nullptr,
+     {SpvOpImage, SpvOpImageDrefGather, SpvOpImageFetch, SpvOpImageGather,
+      SpvOpImageQueryFormat, SpvOpImageQueryLevels, SpvOpImageQueryLod,
+      SpvOpImageQueryOrder, SpvOpImageQuerySamples, SpvOpImageQuerySize,
+      SpvOpImageQuerySizeLod, SpvOpImageRead, SpvOpImageSampleDrefExplicitLod,
+      SpvOpImageSampleDrefImplicitLod, SpvOpImageSampleExplicitLod,
+      SpvOpImageSampleImplicitLod, SpvOpImageSampleProjDrefExplicitLod,
+      SpvOpImageSampleProjDrefImplicitLod, SpvOpImageSampleProjExplicitLod,
+      SpvOpImageSampleProjImplicitLod, SpvOpImageSparseDrefGather,
+      SpvOpImageSparseFetch, SpvOpImageSparseGather, SpvOpImageSparseRead,
+      SpvOpImageSparseSampleDrefExplicitLod,
+      SpvOpImageSparseSampleDrefImplicitLod,
+      SpvOpImageSparseSampleExplicitLod, SpvOpImageSparseSampleImplicitLod,
+      SpvOpImageSparseSampleProjDrefExplicitLod,
+      SpvOpImageSparseSampleProjDrefImplicitLod,
+      SpvOpImageSparseSampleProjExplicitLod,
+      SpvOpImageSparseSampleProjImplicitLod, SpvOpImageSparseTexelsResident,
+      SpvOpImageTexelPointer, SpvOpImageWrite, SpvOpSampledImage,
+      SpvOpTypeImage, SpvOpTypeSampledImage}},
+    {ConversionPass, nullptr,
+     {SpvOpBitcast, SpvOpConvertFToS, SpvOpConvertFToU, SpvOpConvertPtrToU,
+      SpvOpConvertSToF, SpvOpConvertUToF, SpvOpConvertUToPtr, SpvOpFConvert,
+      SpvOpGenericCastToPtr, SpvOpGenericCastToPtrExplicit,
+      SpvOpPtrCastToGeneric, SpvOpQuantizeToF16, SpvOpSConvert,
+      SpvOpSatConvertSToU, SpvOpSatConvertUToS, SpvOpUConvert}},
+    {CompositesPass, nullptr,
+     {SpvOpCompositeConstruct, SpvOpCompositeExtract, SpvOpCompositeInsert,
+      SpvOpCopyLogical, SpvOpCopyObject, SpvOpTranspose,
+      SpvOpVectorExtractDynamic, SpvOpVectorInsertDynamic,
+      SpvOpVectorShuffle}},
+    {ArithmeticsPass, nullptr,
+     {SpvOpCooperativeMatrixMulAddNV, SpvOpDot, SpvOpFAdd, SpvOpFDiv,
+      SpvOpFMod, SpvOpFMul, SpvOpFNegate, SpvOpFRem, SpvOpFSub, SpvOpIAdd,
+      SpvOpIAddCarry, SpvOpIMul, SpvOpISub, SpvOpISubBorrow,
+      SpvOpMatrixTimesMatrix, SpvOpMatrixTimesScalar, SpvOpMatrixTimesVector,
+      SpvOpOuterProduct, SpvOpSDiv, SpvOpSMod, SpvOpSMulExtended,
+      SpvOpSNegate, SpvOpSRem, SpvOpUDiv, SpvOpUMod, SpvOpUMulExtended,
+      SpvOpVectorTimesMatrix, SpvOpVectorTimesScalar}},
+    {BitwisePass, nullptr,
+     {SpvOpBitCount, SpvOpBitFieldInsert, SpvOpBitFieldSExtract,
+      SpvOpBitFieldUExtract, SpvOpBitReverse, SpvOpBitwiseAnd, SpvOpBitwiseOr,
+      SpvOpBitwiseXor, SpvOpNot, SpvOpShiftLeftLogical,
+      SpvOpShiftRightArithmetic, SpvOpShiftRightLogical}},
+    {LogicalsPass, nullptr,
+     {SpvOpAll, SpvOpAny, SpvOpFOrdEqual, SpvOpFOrdGreaterThan,
+      SpvOpFOrdGreaterThanEqual, SpvOpFOrdLessThan, SpvOpFOrdLessThanEqual,
+      SpvOpFOrdNotEqual, SpvOpFUnordEqual, SpvOpFUnordGreaterThan,
+      SpvOpFUnordGreaterThanEqual, SpvOpFUnordLessThan,
+      SpvOpFUnordLessThanEqual, SpvOpFUnordNotEqual, SpvOpIEqual,
+      SpvOpINotEqual, SpvOpIsFinite, SpvOpIsInf, SpvOpIsNan, SpvOpIsNormal,
+      SpvOpLessOrGreater, SpvOpLogicalAnd, SpvOpLogicalEqual, SpvOpLogicalNot,
+      SpvOpLogicalNotEqual, SpvOpLogicalOr, SpvOpOrdered, SpvOpSGreaterThan,
+      SpvOpSGreaterThanEqual, SpvOpSLessThan, SpvOpSLessThanEqual,
+      SpvOpSelect, SpvOpSignBitSet, SpvOpUGreaterThan, SpvOpUGreaterThanEqual,
+      SpvOpULessThan, SpvOpULessThanEqual, SpvOpUnordered}},
+    {ControlFlowPass, nullptr,
+     {SpvOpBranch, SpvOpBranchConditional, SpvOpLoopMerge, SpvOpPhi,
+      SpvOpReturnValue, SpvOpSwitch}},
+    {DerivativesPass, nullptr,
+     {SpvOpDPdx, SpvOpDPdxCoarse, SpvOpDPdxFine, SpvOpDPdy, SpvOpDPdyCoarse,
+      SpvOpDPdyFine, SpvOpFwidth, SpvOpFwidthCoarse, SpvOpFwidthFine}},
+    {AtomicsPass, nullptr,
+     {SpvOpAtomicAnd, SpvOpAtomicCompareExchange,
+      SpvOpAtomicCompareExchangeWeak, SpvOpAtomicExchange, SpvOpAtomicFAddEXT,
+      SpvOpAtomicFlagClear, SpvOpAtomicFlagTestAndSet, SpvOpAtomicIAdd,
+      SpvOpAtomicIDecrement, SpvOpAtomicIIncrement, SpvOpAtomicISub,
+      SpvOpAtomicLoad, SpvOpAtomicOr, SpvOpAtomicSMax, SpvOpAtomicSMin,
+      SpvOpAtomicStore, SpvOpAtomicUMax, SpvOpAtomicUMin, SpvOpAtomicXor}},
+    {PrimitivesPass, nullptr,
+     {SpvOpEmitStreamVertex, SpvOpEmitVertex, SpvOpEndPrimitive,
+      SpvOpEndStreamPrimitive}},
+    {BarriersPass, nullptr,
+     {SpvOpControlBarrier, SpvOpMemoryBarrier, SpvOpMemoryNamedBarrier,
+      SpvOpNamedBarrierInitialize}},
+    {NonUniformPass, spvOpcodeIsNonUniformGroupOperation,
+     {SpvOpGroupNonUniformBallotBitCount}},
+    // The only instructions with literal numbers narrower than a word.
+    {LiteralsPass, nullptr, {SpvOpConstant, SpvOpSpecConstant, SpvOpSwitch}},
+  };
+  return passes;
+}
+
+// Returns the passes to run on an instruction, indexed by its opcode.  Each
+// opcode gets just the passes that do anything for it, in the same order as
+// the full list, so the diagnostics are the same as running every pass.
+const std::vector<std::vector<InstructionPassFn>>& InstructionPassesByOpcode() {
+  static const std::vector<std::vector<InstructionPassFn>> by_opcode = []() {
+    spv_opcode_table opcode_table = nullptr;
+    spvOpcodeTableGet(&opcode_table, SPV_ENV_UNIVERSAL_1_0);
+    uint32_t max_opcode = 0;
+    for (uint32_t i = 0; i < opcode_table->count; ++i) {
+      max_opcode =
+          std::max<uint32_t>(max_opcode, opcode_table->entries[i].opcode);
+    }
+
+    std::vector<std::vector<InstructionPassFn>> table(max_opcode + 1);
+    for (const auto& entry : AllInstructionPasses()) {
+      std::vector<bool> handled(table.size(), false);
+      for (const SpvOp opcode : entry.opcodes) {
+        if (size_t(opcode) < table.size()) handled[opcode] = true;
+      }
+      for (uint32_t i = 0; i < opcode_table->count; ++i) {
+        const SpvOp opcode = opcode_table->entries[i].opcode;
+        if (entry.handles && entry.handles(opcode)) handled[opcode] = true;
+      }
+      for (size_t opcode = 0; opcode < table.size(); ++opcode) {
+        if (handled[opcode]) table[opcode].push_back(entry.pass);
+      }
+    }
+    return table;
+  }();
+  return by_opcode;
+}
+
+// Runs the checks of a single instruction.
+spv_result_t InstructionPasses(ValidationState_t& _, const Instruction* inst) {
+  const auto& by_opcode = InstructionPassesByOpcode();
+  // The parser rejects unknown opcodes, so every instruction should have an
+  // entry.
+  const size_t opcode = size_t(inst->opcode());
+  if (opcode >= by_opcode.size()) {
+    return _.diag(SPV_ERROR_INTERNAL, inst)
+           << "No instruction passes for opcode " << opcode << ".";
+  }
+  const std::vector<InstructionPassFn>& passes = by_opcode[opcode];
+#ifndef NDEBUG
+  // Debug builds run every pass, in order, and check that the passes left out
+  // for this opcode accept it, so the table can't drift from the passes.
+  auto next = passes.begin();
+  for (const auto& entry : AllInstructionPasses()) {
+    if (next != passes.end() && *next == entry.pass) {
+      ++next;
+      if (auto error = entry.pass(_, inst)) return error;
+      continue;
+    }
+    const spv_result_t skipped_result = entry.pass(_, inst);
+    assert(skipped_result == SPV_SUCCESS &&
+           "An instruction pass handles an opcode missing from its entry in "
+           "AllInstructionPasses");
+    (void)skipped_result;
+  }
+#else
+  for (const InstructionPassFn pass : passes) {
+    if (auto error = pass(_, inst)) return error;
+  }
+#endif
+  return SPV_SUCCESS;
+}
+
+// A diagnostic held back while checks run on worker threads.
+struct HeldMessage {
+  spv_message_level_t level;
+  std::string source;
+  spv_position_t position;
+  std::string message;
+};
+
+// Calls |check| with each index from 0 to |num_parts| - 1 on a pool of
+// threads.  The diagnostics of each part are held back, then those of the
+// parts up to the first failing one are emitted in order, and its error is
+// returned.  This gives the same result as calling |check| serially in
+// index order, as long as the parts only change state of their own.
+spv_result_t CheckInParallel(ValidationState_t& _, size_t num_parts,
+                             const std::function<spv_result_t(size_t)>& check) {
+  const size_t num_threads =
+      std::min<size_t>(std::thread::hardware_concurrency(), num_parts);
+  if (num_threads < 2) {
+    for (size_t i = 0; i < num_parts; ++i) {
+      if (auto error = check(i)) return error;
+    }
+    return SPV_SUCCESS;
+  }
+
+  std::vector<spv_result_t> results(num_parts, SPV_SUCCESS);
+  std::vector<std::vector<HeldMessage>> messages(num_parts);
+  std::atomic<size_t> next_part(0);
+  std::atomic<size_t> first_failure(num_parts);
+  auto work = [&]() {
+    for (size_t i = next_part++; i < num_parts; i = next_part++) {
+      // Nothing after the first failure is reported.
+      if (i > first_failure) continue;
+      std::vector<HeldMessage>* held = &messages[i];
+      const MessageConsumer consumer =
+          [held](spv_message_level_t level, const char* source,
+                 const spv_position_t& position, const char* message) {
+            held->push_back({level, source, position, message});
+          };
+      ValidationState_t::SetThreadMessageConsumer(&consumer);
+      results[i] = check(i);
+      ValidationState_t::SetThreadMessageConsumer(nullptr);
+      if (results[i] == SPV_SUCCESS) continue;
+      size_t failure = first_failure;
+      while (i < failure && !first_failure.compare_exchange_weak(failure, i)) {
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_threads; ++i) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+
+  const MessageConsumer& consumer = _.context()->consumer;
+  for (size_t i = 0; i < num_parts; ++i) {
+    if (consumer) {
+      for (const auto& held : messages[i]) {
+        consumer(held.level, held.source.c_str(), held.position,
+                 held.message.c_str());
+      }
+    }
+    if (results[i] != SPV_SUCCESS) return results[i];
+  }
+  return SPV_SUCCESS;
+}
+
 spv_result_t ValidateBinaryUsingContextAndValidationState(
     const spv_context_t& context, const uint32_t* words, const size_t num_words,
     spv_diagnostic* pDiagnostic, ValidationState_t* vstate) {
@@ -315,38 +582,38 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
     if (auto error = UpdateIdUse(*vstate, &instruction)) return error;
   }
 
-  // Validate individual opcodes.
-  for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
-    auto& instruction = vstate->ordered_instructions()[i];
-
-    // Keep these passes in the order they appear in the SPIR-V specification
-    // sections to maintain test consistency.
-    if (auto error = MiscPass(*vstate, &instruction)) return error;
-    if (auto error = DebugPass(*vstate, &instruction)) return error;
-    if (auto error = AnnotationPass(*vstate, &instruction)) return error;
-    if (auto error = ExtensionPass(*vstate, &instruction)) return error;
-    if (auto error = ModeSettingPass(*vstate, &instruction)) return error;
-    if (auto error = TypePass(*vstate, &instruction)) return error;
-    if (auto error = ConstantPass(*vstate, &instruction)) return error;
-    if (auto error = MemoryPass(*vstate, &instruction)) return error;
-    if (auto error = FunctionPass(*vstate, &instruction)) return error;
-    if (auto error = ImagePass(*vstate, &instruction)) return error;
-    if (auto error = ConversionPass(*vstate, &instruction)) return error;
-    if (auto error = CompositesPass(*vstate, &instruction)) return error;
-    if (auto error = ArithmeticsPass(*vstate, &instruction)) return error;
-    if (auto error = BitwisePass(*vstate, &instruction)) return error;
-    if (auto error = LogicalsPass(*vstate, &instruction)) return error;
-    if (auto error = ControlFlowPass(*vstate, &instruction)) return error;
-    if (auto error = DerivativesPass(*vstate, &instruction)) return error;
-    if (auto error = AtomicsPass(*vstate, &instruction)) return error;
-    if (auto error = PrimitivesPass(*vstate, &instruction)) return error;
-    if (auto error = BarriersPass(*vstate, &instruction)) return error;
-    // Group
-    // Device-Side Enqueue
-    // Pipe
-    if (auto error = NonUniformPass(*vstate, &instruction)) return error;
-
-    if (auto error = LiteralsPass(*vstate, &instruction)) return error;
+  // Validate individual opcodes.  The instructions of a function body only
+  // change the state of their own function, so in parallel mode the bodies
+  // are validated on separate threads once the rest of the module is done.
+  const auto& instructions = vstate->ordered_instructions();
+  std::vector<size_t> function_begins;
+  size_t serial_end = instructions.size();
+  if (vstate->options()->parallel) {
+    for (size_t i = 0; i < instructions.size(); ++i) {
+      if (instructions[i].opcode() == SpvOpFunction) {
+        function_begins.push_back(i);
+      }
+    }
+    if (!function_begins.empty()) serial_end = function_begins.front();
+    function_begins.push_back(instructions.size());
+  }
+  for (size_t i = 0; i < serial_end; ++i) {
+    if (auto error = InstructionPasses(*vstate, &instructions[i])) return error;
+  }
+  if (serial_end < instructions.size()) {
+    if (auto error = CheckInParallel(
+            *vstate, function_begins.size() - 1,
+            [&function_begins, &instructions, vstate](size_t function) {
+              for (size_t i = function_begins[function];
+                   i < function_begins[function + 1]; ++i) {
+                if (auto pass_error =
+                        InstructionPasses(*vstate, &instructions[i]))
+                  return pass_error;
+              }
+              return SPV_SUCCESS;
+            })) {
+      return error;
+    }
   }
 
   // Validate the preconditions involving adjacent instructions. e.g. SpvOpPhi
@@ -356,7 +623,18 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   if (auto error = ValidateEntryPoints(*vstate)) return error;
   // CFG checks are performed after the binary has been parsed
   // and the CFGPass has collected information about the control flow
-  if (auto error = PerformCfgChecks(*vstate)) return error;
+  if (vstate->options()->parallel) {
+    auto& functions = vstate->functions();
+    if (auto error = CheckInParallel(*vstate, functions.size(),
+                                     [&functions, vstate](size_t function) {
+                                       return PerformCfgChecks(
+                                           *vstate, functions[function]);
+                                     })) {
+      return error;
+    }
+  } else if (auto error = PerformCfgChecks(*vstate)) {
+    return error;
+  }
   if (auto error = CheckIdDefinitionDominateUse(*vstate)) return error;
   if (auto error = ValidateDecorations(*vstate)) return error;
   if (auto error = ValidateInterfaces(*vstate)) return error;
@@ -365,9 +643,16 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   if (auto error = ValidateBuiltIns(*vstate)) return error;
   // These checks must be performed after individual opcode checks because
   // those checks register the limitation checked here.
+  // Only functions have limitations, and only results have small types.
+  const bool check_small_types = vstate->HasCapability(SpvCapabilityShader);
   for (const auto& inst : vstate->ordered_instructions()) {
-    if (auto error = ValidateExecutionLimitations(*vstate, &inst)) return error;
-    if (auto error = ValidateSmallTypeUses(*vstate, &inst)) return error;
+    if (inst.opcode() == SpvOpFunction) {
+      if (auto error = ValidateExecutionLimitations(*vstate, &inst))
+        return error;
+    }
+    if (check_small_types && inst.type_id() != 0) {
+      if (auto error = ValidateSmallTypeUses(*vstate, &inst)) return error;
+    }
   }
 
   return SPV_SUCCESS;
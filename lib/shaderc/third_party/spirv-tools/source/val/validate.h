@@ -29,6 +29,7 @@ namespace val {
 
 class ValidationState_t;
 class BasicBlock;
+class Function;
 class Instruction;
 
 /// A function that returns a vector of BasicBlocks given a BasicBlock. Used to
@@ -43,6 +44,17 @@ using get_blocks_func =
 /// @return SPV_SUCCESS if no errors are found. SPV_ERROR_INVALID_CFG otherwise
 spv_result_t PerformCfgChecks(ValidationState_t& _);
 
+/// @brief Performs the Control Flow Graph checks on one function
+///
+/// Only changes the state of |function|, so functions can be checked on
+/// separate threads.
+///
+/// @param[in] _ the validation state of the module
+/// @param[in] function the function to check
+///
+/// @return SPV_SUCCESS if no errors are found. SPV_ERROR_INVALID_CFG otherwise
+spv_result_t PerformCfgChecks(ValidationState_t& _, Function& function);
+
 /// @brief Updates the use vectors of all instructions that can be referenced
 ///
 /// This function will update the vector which define where an instruction was
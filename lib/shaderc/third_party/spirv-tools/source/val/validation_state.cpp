@@ -30,6 +30,10 @@ namespace spvtools {
 namespace val {
 namespace {
 
+// Where the diagnostics made on this thread go, if not to the context's
+// consumer.  See ValidationState_t::SetThreadMessageConsumer.
+thread_local const MessageConsumer* thread_message_consumer = nullptr;
+
 ModuleLayoutSection InstructionLayoutSection(
     ModuleLayoutSection current_section, SpvOp op) {
   // See Section 2.4
@@ -148,6 +152,7 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       unresolved_forward_ids_{},
       operand_names_{},
       current_layout_section_(kLayoutCapabilities),
+      no_decorations_(),
       module_functions_(),
       module_capabilities_(),
       module_extensions_(),
@@ -281,11 +286,19 @@ bool ValidationState_t::IsOpcodeInCurrentLayoutSection(SpvOp op) {
   return IsInstructionInLayoutSection(current_layout_section_, op);
 }
 
+void ValidationState_t::SetThreadMessageConsumer(
+    const MessageConsumer* consumer) {
+  thread_message_consumer = consumer;
+}
+
 DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
                                          const Instruction* inst) {
+  const MessageConsumer& consumer = thread_message_consumer
+                                        ? *thread_message_consumer
+                                        : context_->consumer;
   if (error_code == SPV_WARNING) {
     if (num_of_warnings_ == max_num_of_warnings_) {
-      DiagnosticStream({0, 0, 0}, context_->consumer, "", error_code)
+      DiagnosticStream({0, 0, 0}, consumer, "", error_code)
           << "Other warnings have been suppressed.\n";
     }
     if (num_of_warnings_ >= max_num_of_warnings_) {
@@ -297,8 +310,8 @@ DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
   std::string disassembly;
   if (inst) disassembly = Disassemble(*inst);
 
-  return DiagnosticStream({0, 0, inst ? inst->LineNum() : 0},
-                          context_->consumer, disassembly, error_code);
+  return DiagnosticStream({0, 0, inst ? inst->LineNum() : 0}, consumer,
+                          disassembly, error_code);
 }
 
 std::vector<Function>& ValidationState_t::functions() {
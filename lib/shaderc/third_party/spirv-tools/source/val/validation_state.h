@@ -207,6 +207,11 @@ class ValidationState_t {
 
   DiagnosticStream diag(spv_result_t error_code, const Instruction* inst);
 
+  /// Sends the diagnostics made on the calling thread to |consumer| instead of
+  /// the context's consumer.  Passing nullptr restores the context's consumer.
+  /// Used to collect the diagnostics of checks that run on worker threads.
+  static void SetThreadMessageConsumer(const MessageConsumer* consumer);
+
   /// Returns the function states
   std::vector<Function>& functions();
 
@@ -416,11 +421,12 @@ class ValidationState_t {
     }
   }
 
-  /// Returns all the decorations for the given <id>. If no decorations exist
-  /// for the <id>, it registers an empty vector for it in the map and
-  /// returns the empty vector.
-  std::vector<Decoration>& id_decorations(uint32_t id) {
-    return id_decorations_[id];
+  /// Returns all the decorations for the given <id>, or an empty vector if it
+  /// has none.  Does not change the state, so validation threads can share it.
+  const std::vector<Decoration>& id_decorations(uint32_t id) const {
+    const auto decorations = id_decorations_.find(id);
+    if (decorations == id_decorations_.end()) return no_decorations_;
+    return decorations->second;
   }
 
   // Returns const pointer to the internal decoration container.
@@ -770,6 +776,9 @@ class ValidationState_t {
   /// The section of the code being processed
   ModuleLayoutSection current_layout_section_;
 
+  /// Returned by id_decorations() for ids without decorations.
+  const std::vector<Decoration> no_decorations_;
+
   /// A list of functions in the module.
   /// Pointers to objects in this container are guaranteed to be stable and
   /// valid until the end of lifetime of the validation state.
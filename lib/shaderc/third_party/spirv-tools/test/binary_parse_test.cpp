@@ -819,6 +819,132 @@ INSTANTIATE_TEST_SUITE_P(
          "Type Id 1 is not a scalar numeric type"},
     }));
 
+// What spvBinaryParse reported for a module.
+struct ParseRecord {
+  spv_result_t result;
+  std::string diagnostic;
+  std::vector<ParsedInstruction> instructions;
+};
+
+// Parses |words|, byte-swapped first if |flip_words| is true, and records the
+// outcome.
+ParseRecord ParseAndRecord(const std::vector<uint32_t>& words,
+                           bool flip_words) {
+  std::vector<uint32_t> flipped_words(words);
+  if (flip_words) {
+    std::transform(flipped_words.begin(), flipped_words.end(),
+                   flipped_words.begin(), [](const uint32_t raw_word) {
+                     return spvFixWord(raw_word,
+                                       I32_ENDIAN_HOST == I32_ENDIAN_BIG
+                                           ? SPV_ENDIANNESS_LITTLE
+                                           : SPV_ENDIANNESS_BIG);
+                   });
+  }
+  ParseRecord record;
+  spv_diagnostic diagnostic = nullptr;
+  record.result = spvBinaryParse(
+      ScopedContext().context, &record.instructions, flipped_words.data(),
+      flipped_words.size(), nullptr,
+      [](void* user_data, const spv_parsed_instruction_t* inst) {
+        static_cast<std::vector<ParsedInstruction>*>(user_data)->emplace_back(
+            *inst);
+        return SPV_SUCCESS;
+      },
+      &diagnostic);
+  if (diagnostic) {
+    record.diagnostic = diagnostic->error;
+    spvDiagnosticDestroy(diagnostic);
+  }
+  return record;
+}
+
+using BinaryParseEndiannessTest =
+    spvtest::TextToBinaryTestBase<::testing::Test>;
+
+// Simple instructions in native endian modules skip the expected-operand
+// pattern.  Byte-swapped modules always go through it, so both must report
+// the same instructions, results and diagnostics, also for broken modules.
+// Literal strings are read as bytes in whatever order the module has them, so
+// the module has no strings; the parser does not need an entry point.
+TEST_F(BinaryParseEndiannessTest, NativeAndSwappedModulesParseAlike) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpCapability Linkage
+               OpMemoryModel Logical GLSL450
+               OpExecutionMode %main OriginUpperLeft
+               OpDecorate %color Location 0
+       %void = OpTypeVoid
+       %bool = OpTypeBool
+      %float = OpTypeFloat 32
+        %int = OpTypeInt 32 1
+    %v4float = OpTypeVector %float 4
+   %fn_float = OpTypeFunction %float %float %float
+    %fn_void = OpTypeFunction %void
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+%_ptr_Function_float = OpTypePointer Function %float
+      %color = OpVariable %_ptr_Output_v4float Output
+    %float_1 = OpConstant %float 1
+      %int_0 = OpConstant %int 0
+  %composite = OpConstantComposite %v4float %float_1 %float_1 %float_1 %float_1
+        %add = OpFunction %float None %fn_float
+          %a = OpFunctionParameter %float
+          %b = OpFunctionParameter %float
+  %add_entry = OpLabel
+        %sum = OpFAdd %float %a %b
+     %square = OpFMul %float %sum %sum
+               OpReturnValue %square
+               OpFunctionEnd
+       %main = OpFunction %void None %fn_void
+ %main_entry = OpLabel
+        %tmp = OpVariable %_ptr_Function_float Function
+       %call = OpFunctionCall %float %add %float_1 %float_1
+               OpStore %tmp %call
+     %loaded = OpLoad %float %tmp
+       %less = OpFOrdLessThan %bool %loaded %float_1
+               OpSelectionMerge %merge None
+               OpBranchConditional %less %then %merge 1 2
+       %then = OpLabel
+     %scaled = OpVectorTimesScalar %v4float %composite %loaded
+               OpBranch %merge
+      %merge = OpLabel
+        %phi = OpPhi %v4float %composite %main_entry %scaled %then
+   %shuffled = OpVectorShuffle %v4float %phi %phi 3 2 1 0
+          %x = OpCompositeExtract %float %shuffled 0
+      %built = OpCompositeConstruct %v4float %x %x %x %x
+               OpStore %color %built
+               OpReturn
+               OpFunctionEnd
+)";
+  const SpirvVector words = CompileSuccessfully(text);
+  {
+    const ParseRecord native = ParseAndRecord(words, false);
+    const ParseRecord swapped = ParseAndRecord(words, true);
+    ASSERT_EQ(SPV_SUCCESS, native.result) << native.diagnostic;
+    EXPECT_EQ(SPV_SUCCESS, swapped.result);
+    EXPECT_THAT(native.instructions, Eq(swapped.instructions));
+  }
+
+  // Break each word after the header in turn: a zero makes zero Ids and word
+  // counts, a large value makes bad opcodes, overlong instructions and Ids out
+  // of bounds, and a copy of the next word makes redefined result Ids.
+  for (size_t index = SPV_INDEX_INSTRUCTION; index < words.size(); ++index) {
+    const uint32_t replacements[] = {
+        0u, 0xffff0000u | words[index],
+        index + 1 < words.size() ? words[index + 1] : 1u};
+    for (const uint32_t replacement : replacements) {
+      SpirvVector broken(words);
+      broken[index] = replacement;
+      const ParseRecord native = ParseAndRecord(broken, false);
+      const ParseRecord swapped = ParseAndRecord(broken, true);
+      SCOPED_TRACE("word " + std::to_string(index) + " set to " +
+                   std::to_string(replacement));
+      EXPECT_EQ(native.result, swapped.result);
+      EXPECT_EQ(native.diagnostic, swapped.diagnostic);
+      EXPECT_THAT(native.instructions, Eq(swapped.instructions));
+    }
+  }
+}
+
 // A binary parser diagnostic case generated from an assembly text input.
 struct AssemblyDiagnosticCase {
   std::string assembly;
@@ -493,6 +493,72 @@ OpMemoryModel Logical GLSL450 ; 0x0000001c
               expected);
 }
 
+// Returns the assembly of a module large enough to be disassembled in
+// parallel: many small functions, each calling the one before it.
+std::string ManyFunctionsModule() {
+  std::ostringstream text;
+  text << "OpCapability Shader\nOpCapability Linkage\n"
+       << "OpMemoryModel Logical GLSL450\n"
+       << "OpName %f0 \"first\"\nOpName %p1 \"param\"\n"
+       << "%int = OpTypeInt 32 1\n%int_1 = OpConstant %int 1\n"
+       << "%fn = OpTypeFunction %int %int\n";
+  for (int f = 0; f < 1200; ++f) {
+    const std::string i = std::to_string(f);
+    text << "%f" << i << " = OpFunction %int None %fn\n"
+         << "%p" << i << " = OpFunctionParameter %int\n"
+         << "%l" << i << " = OpLabel\n"
+         << "%a" << i << "_0 = OpIAdd %int %p" << i << " %int_1\n";
+    for (int a = 1; a < 10; ++a) {
+      text << "%a" << i << "_" << a << " = OpIMul %int %a" << i << "_"
+           << a - 1 << " %int_1\n";
+    }
+    if (f > 0) {
+      text << "%c" << i << " = OpFunctionCall %int %f" << f - 1 << " %a" << i
+           << "_9\nOpReturnValue %c" << i << "\n";
+    } else {
+      text << "OpReturnValue %a0_9\n";
+    }
+    text << "OpFunctionEnd\n";
+  }
+  return text.str();
+}
+
+using ParallelDisassemblyTest =
+    spvtest::TextToBinaryTestBase<::testing::TestWithParam<uint32_t>>;
+
+// Function bodies are only disassembled on several threads when the host has
+// them, so this checks the two paths against each other on such hosts.
+TEST_P(ParallelDisassemblyTest, MatchesSerialDisassembly) {
+  const SpirvVector words = CompileSuccessfully(ManyFunctionsModule());
+  ASSERT_GE(words.size(), 1u << 16);
+
+  std::string texts[2];
+  const uint32_t options[2] = {GetParam(),
+                               GetParam() | SPV_BINARY_TO_TEXT_OPTION_PARALLEL};
+  for (int i = 0; i < 2; ++i) {
+    spv_text decoded_text = nullptr;
+    ASSERT_EQ(SPV_SUCCESS,
+              spvBinaryToText(ScopedContext().context, words.data(),
+                              words.size(), options[i], &decoded_text,
+                              &diagnostic));
+    texts[i].assign(decoded_text->str, decoded_text->length);
+    spvTextDestroy(decoded_text);
+  }
+  EXPECT_EQ(texts[0], texts[1]);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParallelDisassembly, ParallelDisassemblyTest,
+    ::testing::Values(
+        SPV_BINARY_TO_TEXT_OPTION_NONE,
+        SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES,
+        SPV_BINARY_TO_TEXT_OPTION_INDENT |
+            SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES,
+        SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET,
+        SPV_BINARY_TO_TEXT_OPTION_NO_HEADER |
+            SPV_BINARY_TO_TEXT_OPTION_COMMENT |
+            SPV_BINARY_TO_TEXT_OPTION_INDENT));
+
 // Test version string.
 TEST_F(TextToBinaryTest, VersionString) {
   auto words = CompileSuccessfully("");
@@ -0,0 +1,164 @@
+// Copyright (c) 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "test/link/linker_fixture.h"
+
+namespace spvtools {
+namespace {
+
+using DeduplicateWhileMerging = spvtest::LinkerTest;
+
+LinkerOptions DeduplicatingOptions() {
+  LinkerOptions options;
+  options.SetDeduplicateWhileMerging(true);
+  return options;
+}
+
+size_t CountOccurrences(const std::string& text, const std::string& pattern) {
+  size_t count = 0u;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1u))
+    ++count;
+  return count;
+}
+
+TEST_F(DeduplicateWhileMerging, MatchesRemoveDuplicatesPass) {
+  const std::vector<std::string> bodies = {
+      // clang-format off
+      R"(OpCapability Shader
+OpCapability Linkage
+%ext = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpName %foo "foo"
+OpName %s "S"
+OpMemberName %s 0 "a"
+OpDecorate %foo LinkageAttributes "foo" Export
+OpMemberDecorate %s 0 Offset 0
+OpMemberDecorate %s 1 Offset 16
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%v4float = OpTypeVector %float 4
+%s = OpTypeStruct %v4float %float
+%ptr = OpTypePointer Function %s
+%fn = OpTypeFunction %float %ptr
+%float_2 = OpConstant %float 2
+%foo = OpFunction %float None %fn
+%p = OpFunctionParameter %ptr
+%entry = OpLabel
+%x = OpExtInst %float %ext Sqrt %float_2
+OpReturnValue %x
+OpFunctionEnd
+)",
+      R"(OpCapability Shader
+OpCapability Linkage
+%ext = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpName %s "T"
+OpName %bar "bar"
+OpDecorate %foo LinkageAttributes "foo" Import
+OpMemberDecorate %s 1 Offset 16
+OpMemberDecorate %s 0 Offset 0
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%v4float = OpTypeVector %float 4
+%s = OpTypeStruct %v4float %float
+%ptr = OpTypePointer Function %s
+%fn = OpTypeFunction %float %ptr
+%void_fn = OpTypeFunction %void
+%foo = OpFunction %float None %fn
+%p = OpFunctionParameter %ptr
+OpFunctionEnd
+%bar = OpFunction %void None %void_fn
+%entry = OpLabel
+%var = OpVariable %ptr Function
+%y = OpFunctionCall %float %foo %var
+%z = OpExtInst %float %ext Floor %y
+OpReturn
+OpFunctionEnd
+)",
+      // clang-format on
+  };
+  // Only the first module has a constant, so both ways of linking keep the
+  // same globals.
+  spvtest::Binary default_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &default_binary))
+      << GetErrorMessage();
+  spvtest::Binary deduplicated_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink(bodies, &deduplicated_binary,
+                                         DeduplicatingOptions()))
+      << GetErrorMessage();
+
+  std::string default_text;
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(default_binary, &default_text));
+  std::string deduplicated_text;
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(deduplicated_binary, &deduplicated_text));
+  EXPECT_EQ(default_text, deduplicated_text);
+  EXPECT_EQ(1u, CountOccurrences(deduplicated_text, "OpTypeStruct"));
+  EXPECT_EQ(1u, CountOccurrences(deduplicated_text, "OpExtInstImport"));
+  EXPECT_EQ(1u, CountOccurrences(deduplicated_text, "OpCapability Shader"));
+  EXPECT_EQ(2u, CountOccurrences(deduplicated_text, "OpMemberDecorate"));
+}
+
+TEST_F(DeduplicateWhileMerging, SharesConstants) {
+  const std::string body = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%int = OpTypeInt 32 1
+%v2int = OpTypeVector %int 2
+%int_1 = OpConstant %int 1
+%int_2 = OpConstant %int 2
+%pair = OpConstantComposite %v2int %int_1 %int_2
+%spec = OpSpecConstant %int 1
+)";
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS, AssembleAndLink({body, body, body}, &linked_binary,
+                                         DeduplicatingOptions()))
+      << GetErrorMessage();
+
+  std::string text;
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &text));
+  EXPECT_EQ(1u, CountOccurrences(text, "OpTypeInt"));
+  EXPECT_EQ(2u, CountOccurrences(text, "OpConstant %"));
+  EXPECT_EQ(1u, CountOccurrences(text, "OpConstantComposite"));
+  // Specialization constants can each be given their own value.
+  EXPECT_EQ(3u, CountOccurrences(text, "OpSpecConstant"));
+}
+
+TEST_F(DeduplicateWhileMerging, KeepsDifferentlyDecoratedTypes) {
+  const std::string body = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpMemberDecorate %s 0 Offset {0,4}
+%int = OpTypeInt 32 1
+%s = OpTypeStruct %int
+%ptr = OpTypePointer Uniform %s
+)";
+  spvtest::Binary linked_binary;
+  ASSERT_EQ(SPV_SUCCESS,
+            ExpandAndLink(body, &linked_binary, DeduplicatingOptions()))
+      << GetErrorMessage();
+
+  std::string text;
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &text));
+  EXPECT_EQ(1u, CountOccurrences(text, "OpTypeInt"));
+  EXPECT_EQ(2u, CountOccurrences(text, "OpTypeStruct"));
+  EXPECT_EQ(2u, CountOccurrences(text, "OpTypePointer"));
+}
+
+}  // namespace
+}  // namespace spvtools
@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 
+#include "source/text_handler.h"
 #include "test/test_fixture.h"
 #include "test/unit_spirv.h"
 
@@ -47,6 +48,78 @@ TEST_F(NamedIdTest, Default) {
   EXPECT_EQ(output, EncodeAndDecodeSuccessfully(input));
 }
 
+// Returns the name of the |i|th id in ManyNamedIdsText.  Names share prefixes,
+// such as %x1, %x10 and %x100.
+std::string ManyNamedIdsName(int i) {
+  return i == 0 ? "%x" : "%x" + std::to_string(i);
+}
+
+// Returns an assembly with |count| named results after %x, each using two of
+// the ones before it, along with the disassembly it should have.
+void ManyNamedIdsText(int count, std::string* text, std::string* expected) {
+  *text =
+      "OpCapability Shader\nOpMemoryModel Logical GLSL450\n"
+      "%int = OpTypeInt 32 1\n%fn = OpTypeFunction %int\n"
+      "%f = OpFunction %int None %fn\n%entry = OpLabel\n%x = OpUndef %int\n";
+  *expected =
+      "OpCapability Shader\nOpMemoryModel Logical GLSL450\n"
+      "%1 = OpTypeInt 32 1\n%2 = OpTypeFunction %1\n"
+      "%3 = OpFunction %1 None %2\n%4 = OpLabel\n%5 = OpUndef %1\n";
+  // %x gets id 5, and the names after it the ids after that.
+  const auto id = [](int i) { return "%" + std::to_string(5 + i); };
+  for (int i = 1; i <= count; ++i) {
+    *text += ManyNamedIdsName(i) + " = OpIAdd %int " + ManyNamedIdsName(i - 1) +
+             " " + ManyNamedIdsName(i / 10) + "\n";
+    *expected +=
+        id(i) + " = OpIAdd %1 " + id(i - 1) + " " + id(i / 10) + "\n";
+  }
+  *text += "OpReturnValue " + ManyNamedIdsName(count) + "\nOpFunctionEnd\n";
+  *expected += "OpReturnValue " + id(count) + "\nOpFunctionEnd\n";
+}
+
+// Enough names to outgrow the table the text length suggests, and to fill
+// several of its name blocks.
+TEST_F(NamedIdTest, ManyNamesGetIdsInOrderOfAppearance) {
+  std::string text;
+  std::string expected;
+  ManyNamedIdsText(20000, &text, &expected);
+  EXPECT_EQ(expected, EncodeAndDecodeSuccessfully(text));
+}
+
+TEST(NamedIdTable, FindsNamesByLength) {
+  NamedIdTable table(0);
+  const int count = 50000;
+  for (int i = 0; i < count; ++i) {
+    const std::string name = "x" + std::to_string(i);
+    table.Insert(name.c_str(), name.size(), uint32_t(i) + 1);
+  }
+
+  for (int i = 0; i < count; ++i) {
+    const std::string name = "x" + std::to_string(i);
+    uint32_t id = 0;
+    ASSERT_TRUE(table.Find(name.c_str(), name.size(), &id)) << name;
+    EXPECT_EQ(uint32_t(i) + 1, id) << name;
+  }
+
+  // Names are looked up where they appear in the text, so only |length|
+  // characters count.
+  const char text[] = "x12345 = OpIAdd";
+  uint32_t id = 0;
+  ASSERT_TRUE(table.Find(text, 6, &id));
+  EXPECT_EQ(12346u, id);
+  ASSERT_TRUE(table.Find(text, 2, &id));
+  EXPECT_EQ(2u, id);
+  EXPECT_FALSE(table.Find(text, 7, &id));
+  EXPECT_FALSE(table.Find("y1", 2, &id));
+
+  int visited = 0;
+  table.ForEach([&visited](const char* name, uint32_t entry_id) {
+    EXPECT_EQ("x" + std::to_string(entry_id - 1), name);
+    ++visited;
+  });
+  EXPECT_EQ(count, visited);
+}
+
 struct IdCheckCase {
   std::string id;
   bool valid;
@@ -12,7 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <set>
+
 #include "gmock/gmock.h"
+#include "source/assembly_grammar.h"
+#include "source/opcode.h"
+#include "source/operand.h"
+#include "test/test_fixture.h"
 #include "test/unit_spirv.h"
 
 namespace spvtools {
@@ -35,5 +41,65 @@ TEST_P(GetTargetOpcodeTableGetTest, InvalidPointerTable) {
 INSTANTIATE_TEST_SUITE_P(OpcodeTableGet, GetTargetOpcodeTableGetTest,
                          ValuesIn(spvtest::AllTargetEnvironments()));
 
+using GrammarIndexTest = ::testing::TestWithParam<spv_target_env>;
+
+// A context's grammar index must answer every value lookup as the searching
+// lookups over the grammar tables do.
+TEST_P(GrammarIndexTest, OpcodeLookupsMatchTable) {
+  const spv_target_env env = GetParam();
+  spvtest::ScopedContext context(env);
+  ASSERT_NE(nullptr, context.context->grammar_index);
+  AssemblyGrammar grammar(context.context);
+
+  // Opcodes are 16 bits wide.
+  for (uint32_t value = 0; value <= 0xffff; ++value) {
+    const SpvOp opcode = static_cast<SpvOp>(value);
+    spv_opcode_desc expected = nullptr;
+    const spv_result_t expected_result = spvOpcodeTableValueLookup(
+        env, context.context->opcode_table, opcode, &expected);
+    spv_opcode_desc actual = nullptr;
+    ASSERT_EQ(expected_result, grammar.lookupOpcode(opcode, &actual)) << value;
+    ASSERT_EQ(expected, actual) << value;
+  }
+}
+
+TEST_P(GrammarIndexTest, OperandLookupsMatchTable) {
+  const spv_target_env env = GetParam();
+  spvtest::ScopedContext context(env);
+  ASSERT_NE(nullptr, context.context->grammar_index);
+  AssemblyGrammar grammar(context.context);
+  const spv_operand_table table = context.context->operand_table;
+
+  for (uint32_t type = 0; type < SPV_OPERAND_TYPE_NUM_OPERAND_TYPES; ++type) {
+    // Every small value, which covers the directly indexed ones and the gaps
+    // between them, plus every value in the table and the value after it.
+    std::set<uint32_t> values;
+    for (uint32_t value = 0; value < 0x400; ++value) values.insert(value);
+    for (uint32_t i = 0; i < table->count; ++i) {
+      if (table->types[i].type != type) continue;
+      for (uint32_t j = 0; j < table->types[i].count; ++j) {
+        const uint32_t value = table->types[i].entries[j].value;
+        values.insert(value);
+        values.insert(value + 1);
+      }
+    }
+
+    const auto operand_type = static_cast<spv_operand_type_t>(type);
+    for (const uint32_t value : values) {
+      spv_operand_desc expected = nullptr;
+      const spv_result_t expected_result = spvOperandTableValueLookup(
+          env, table, operand_type, value, &expected);
+      spv_operand_desc actual = nullptr;
+      ASSERT_EQ(expected_result,
+                grammar.lookupOperand(operand_type, value, &actual))
+          << "type " << type << " value " << value;
+      ASSERT_EQ(expected, actual) << "type " << type << " value " << value;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(GrammarIndex, GrammarIndexTest,
+                         ValuesIn(spvtest::AllTargetEnvironments()));
+
 }  // namespace
 }  // namespace spvtools
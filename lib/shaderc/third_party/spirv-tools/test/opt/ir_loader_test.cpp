@@ -1504,6 +1504,64 @@ TEST(IrBuilder, UniqueIds) {
   });
 }
 
+TEST(IrBuilder, LoadedInstructionsCloneAndFree) {
+  const std::string text =
+      // clang-format off
+               "OpCapability Shader\n"
+               "OpMemoryModel Logical GLSL450\n"
+               "OpEntryPoint Fragment %main \"main\"\n"
+               "OpExecutionMode %main OriginUpperLeft\n"
+               "OpName %main \"main\"\n"
+               "OpName %x \"a_name_too_long_to_fit_in_an_operand\"\n"
+       "%void = OpTypeVoid\n"
+          "%3 = OpTypeFunction %void\n"
+      "%float = OpTypeFloat 32\n"
+    "%float_1 = OpConstant %float 1\n"
+       "%main = OpFunction %void None %3\n"
+          "%5 = OpLabel\n"
+          "%x = OpFAdd %float %float_1 %float_1\n"
+               "OpReturn\n"
+               "OpFunctionEnd\n";
+  // clang-format on
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text);
+  ASSERT_NE(nullptr, context);
+
+  // Loaded instructions live in the context's arena, while clones come from
+  // the heap and have to stay intact after the context is gone.
+  std::vector<std::unique_ptr<Instruction>> clones;
+  std::vector<std::vector<uint32_t>> expected_words;
+  context->module()->ForEachInst([&](const Instruction* inst) {
+    clones.emplace_back(inst->Clone(context.get()));
+    expected_words.emplace_back();
+    inst->ToBinaryWithoutAttachedDebugInsts(&expected_words.back());
+  });
+
+  // Killing a loaded instruction runs its destructor but leaves its memory to
+  // the arena.
+  Instruction* name = &*context->module()->debug2_begin();
+  ASSERT_EQ(SpvOpName, name->opcode());
+  context->KillInst(name);
+
+  std::vector<uint32_t> binary;
+  context->module()->ToBinary(&binary, /* skip_nop = */ false);
+  std::string disassembled_text;
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  EXPECT_TRUE(t.Disassemble(binary, &disassembled_text));
+  EXPECT_EQ(std::string::npos, disassembled_text.find("OpName %main"));
+  EXPECT_NE(std::string::npos, disassembled_text.find("OpFAdd"));
+
+  context.reset();
+
+  ASSERT_EQ(expected_words.size(), clones.size());
+  for (size_t i = 0; i < clones.size(); ++i) {
+    std::vector<uint32_t> words;
+    clones[i]->ToBinaryWithoutAttachedDebugInsts(&words);
+    EXPECT_THAT(words, ContainerEq(expected_words[i]));
+  }
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
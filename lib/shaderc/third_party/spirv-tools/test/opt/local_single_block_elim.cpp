@@ -13,7 +13,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "test/opt/pass_fixture.h"
 #include "test/opt/pass_utils.h"
@@ -1452,6 +1454,61 @@ TEST_F(LocalSingleBlockLoadStoreElimTest, DebugValueTest) {
   SinglePassRunAndMatch<LocalSingleBlockLoadStoreElimPass>(text, false);
 }
 
+TEST_F(LocalSingleBlockLoadStoreElimTest, ParallelFunctionsMatchSerial) {
+  // Each function stores a value, reloads it, stores the reloaded value to a
+  // second variable and reloads that too.  The second store names a load
+  // that is replaced, so its value has to be followed to the replacement.
+  std::string functions;
+  std::string calls;
+  for (int i = 0; i < 8; ++i) {
+    const std::string n = std::to_string(i);
+    calls += "%call" + n + " = OpFunctionCall %void %f" + n + "\n";
+    functions += R"(
+%f)" + n + R"( = OpFunction %void None %void_fn
+%entry)" + n + R"( = OpLabel
+%a)" + n + R"( = OpVariable %_ptr_Function_float Function
+%b)" + n + R"( = OpVariable %_ptr_Function_float Function
+OpStore %a)" + n + R"( %float_1
+%la)" + n + R"( = OpLoad %float %a)" + n + R"(
+OpStore %b)" + n + R"( %la)" + n + R"(
+%lb)" + n + R"( = OpLoad %float %b)" + n + R"(
+%sum)" + n + R"( = OpFAdd %float %la)" + n + R"( %lb)" + n + R"(
+OpStore %a)" + n + R"( %sum)" + n + R"(
+OpStore %a)" + n + R"( %lb)" + n + R"(
+OpReturn
+OpFunctionEnd
+)";
+  }
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%_ptr_Function_float = OpTypePointer Function %float
+%float_1 = OpConstant %float 1
+%main = OpFunction %void None %void_fn
+%main_entry = OpLabel
+)" + calls + R"(OpReturn
+OpFunctionEnd
+)" + functions;
+
+  std::vector<uint32_t> results[2];
+  for (bool parallel : {false, true}) {
+    std::unique_ptr<IRContext> context =
+        BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                    SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+    ASSERT_NE(nullptr, context);
+    context->set_parallel_functions(parallel);
+    LocalSingleBlockLoadStoreElimPass pass;
+    EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+    context->module()->ToBinary(&results[parallel], false);
+  }
+  EXPECT_EQ(results[0], results[1]);
+}
+
 // TODO(greg-lunarg): Add tests to verify handling of these cases:
 //
 //    Other target variable types
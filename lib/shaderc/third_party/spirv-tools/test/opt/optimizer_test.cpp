@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -68,6 +69,52 @@ TEST(Optimizer, CanRunTransformingPassWithDistinctInputOutputVectors) {
   EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
 }
 
+TEST(Optimizer, ReusesCachedResults) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary_in;
+  tools.Assemble(Header() + "OpName %cached \"cached\"\n%cached = OpTypeVoid",
+                 &binary_in);
+
+  // A hit runs no passes, so nothing is printed.  The first run may already
+  // hit a result stored by an earlier test run.
+  std::vector<uint32_t> binary_out[2];
+  std::ostringstream printed[2];
+  for (int i = 0; i < 2; ++i) {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.SetCacheDirectory(::testing::TempDir());
+    opt.SetPrintAll(&printed[i]);
+    ASSERT_TRUE(opt.RegisterPassFromFlag("--strip-debug"));
+    ASSERT_TRUE(opt.Run(binary_in.data(), binary_in.size(), &binary_out[i]));
+    EXPECT_TRUE(opt.GetPassNames().empty());
+  }
+  EXPECT_THAT(printed[1].str(), Eq(""));
+  EXPECT_THAT(binary_out[1], Eq(binary_out[0]));
+
+  std::string disassembly;
+  tools.Disassemble(binary_out[1].data(), binary_out[1].size(), &disassembly);
+  EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
+}
+
+TEST(Optimizer, DoesNotCacheRunsWithUndescribedPasses) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary_in;
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binary_in);
+
+  // A pass registered directly may have settings the cache can't see.
+  for (int i = 0; i < 2; ++i) {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.SetCacheDirectory(::testing::TempDir());
+    std::ostringstream printed;
+    opt.SetPrintAll(&printed);
+    ASSERT_TRUE(opt.RegisterPassFromFlag("--strip-debug"));
+    opt.RegisterPass(CreateNullPass());
+    std::vector<uint32_t> binary_out;
+    ASSERT_TRUE(opt.Run(binary_in.data(), binary_in.size(), &binary_out));
+    EXPECT_THAT(printed.str(), ::testing::HasSubstr("; IR before pass null"));
+  }
+}
+
 TEST(Optimizer, CanRunNullPassWithAliasedVectors) {
   SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
   std::vector<uint32_t> binary;
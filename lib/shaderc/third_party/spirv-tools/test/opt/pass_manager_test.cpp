@@ -154,6 +154,43 @@ class AppendTypeVoidInstPass : public Pass {
   uint32_t result_id_;
 };
 
+// A pass that counts its runs and never changes the module.
+class CountRunsPass : public Pass {
+ public:
+  explicit CountRunsPass(int* runs) : runs_(runs) {}
+
+  const char* name() const override { return "CountRuns"; }
+  Status Process() override {
+    ++*runs_;
+    return Status::SuccessWithoutChange;
+  }
+
+ private:
+  int* runs_;
+};
+
+TEST(PassManager, SkipUnchangedPasses) {
+  for (bool skip : {false, true}) {
+    PassManager manager;
+    manager.SetSkipUnchangedPasses(skip);
+    std::unique_ptr<Module> module(new Module());
+    IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                      manager.consumer());
+
+    // The second run can't find anything the first didn't.  The third
+    // follows a change, so it runs again.
+    int runs = 0;
+    manager.AddPass(MakeUnique<CountRunsPass>(&runs));
+    manager.AddPass(MakeUnique<CountRunsPass>(&runs));
+    manager.AddPass<AppendOpNopPass>();
+    manager.AddPass(MakeUnique<CountRunsPass>(&runs));
+    EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(&context));
+    EXPECT_EQ(skip ? 2 : 3, runs);
+    EXPECT_EQ(1, std::distance(context.module()->debug1_begin(),
+                               context.module()->debug1_end()));
+  }
+}
+
 TEST(PassManager, RecomputeIdBoundAutomatically) {
   PassManager manager;
   std::unique_ptr<Module> module(new Module());
@@ -14,6 +14,8 @@
 
 #include "source/reduce/reducer.h"
 
+#include <atomic>
+
 #include <unordered_map>
 
 #include "source/opt/build_module.h"
@@ -558,6 +560,48 @@ TEST(ReducerTest, ShaderReduceWhileDivReachable) {
   ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
 }
 
+TEST(ReducerTest, ParallelCandidatesMatchSerialReduction) {
+  std::vector<uint32_t> binary_in;
+  SpirvTools t(kEnv);
+  ASSERT_TRUE(
+      t.Assemble(kShaderWithLoopsDivAndMul, &binary_in, kReduceAssembleOption));
+
+  // Trying several steps at once keeps the step a serial reduction would, so
+  // both the result and the number of interestingness checks it counts match.
+  std::vector<uint32_t> binary_out[2];
+  uint32_t last_step[2] = {0, 0};
+  const uint32_t parallel_candidates[2] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    Reducer reducer(kEnv);
+    std::atomic<uint32_t> max_step(0);
+    reducer.SetInterestingnessFunction(
+        [&max_step](const std::vector<uint32_t>& binary,
+                    uint32_t count) -> bool {
+          uint32_t seen = max_step;
+          while (count > seen && !max_step.compare_exchange_weak(seen, count)) {
+          }
+          return InterestingWhileIMulReachable(binary, count);
+        });
+    reducer.AddDefaultReductionPasses();
+    reducer.SetMessageConsumer(kMessageConsumer);
+
+    spvtools::ReducerOptions reducer_options;
+    reducer_options.set_step_limit(500);
+    reducer_options.set_fail_on_validation_error(true);
+    reducer_options.set_parallel_candidates(parallel_candidates[i]);
+    spvtools::ValidatorOptions validator_options;
+
+    std::vector<uint32_t> binary = binary_in;
+    Reducer::ReductionResultStatus status = reducer.Run(
+        std::move(binary), &binary_out[i], reducer_options, validator_options);
+    ASSERT_EQ(status, Reducer::ReductionResultStatus::kComplete);
+    last_step[i] = max_step;
+  }
+  EXPECT_EQ(binary_out[0], binary_out[1]);
+  // Candidates after the one kept may have been checked too.
+  EXPECT_LE(last_step[0], last_step[1]);
+}
+
 // Computes an instruction count for each function in the module represented by
 // |binary|.
 std::unordered_map<uint32_t, uint32_t> GetFunctionInstructionCount(
@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 
+#include "source/spirv_validator_options.h"
 #include "source/val/validation_state.h"
 #include "spirv-tools/libspirv.h"
 #include "test/test_fixture.h"
@@ -152,8 +153,27 @@ spv_result_t ValidateBase<T>::ValidateInstructions(spv_target_env env) {
     fflush(stderr);
   }
   assert(binary_ != nullptr);
-  return spvValidateWithOptions(ScopedContext(env).context, options_,
-                                get_const_binary(), &diagnostic_);
+  const spv_result_t result = spvValidateWithOptions(
+      ScopedContext(env).context, options_, get_const_binary(), &diagnostic_);
+
+  // Checking function bodies on several threads must give the same result
+  // and diagnostic, so every validation test checks that as well.
+  if (!options_->parallel) {
+    spv_validator_options_t parallel_options = *options_;
+    parallel_options.parallel = true;
+    spv_diagnostic parallel_diagnostic = nullptr;
+    EXPECT_EQ(result, spvValidateWithOptions(ScopedContext(env).context,
+                                             &parallel_options,
+                                             get_const_binary(),
+                                             &parallel_diagnostic));
+    EXPECT_EQ(getDiagnosticString(),
+              parallel_diagnostic == nullptr
+                  ? std::string()
+                  : std::string(parallel_diagnostic->error))
+        << "when validating in parallel";
+    spvDiagnosticDestroy(parallel_diagnostic);
+  }
+  return result;
 }
 
 template <typename T>
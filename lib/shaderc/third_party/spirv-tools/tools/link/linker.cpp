@@ -48,6 +48,10 @@ Options (in lexicographical order):
                unresolved.
   --create-library
                Link the binaries into a library, keeping all exported symbols.
+  --deduplicate-while-merging
+               Drop duplicate types, constants and decorations while merging
+               the binaries, and parse and merge the binaries in parallel.
+               Meant for linking large numbers of modules.
   -h, --help
                   Print this help.
   --target-env <env>
@@ -89,6 +93,8 @@ int main(int argc, char** argv) {
         options.SetAllowPartialLinkage(true);
       } else if (0 == strcmp(cur_arg, "--create-library")) {
         options.SetCreateLibrary(true);
+      } else if (0 == strcmp(cur_arg, "--deduplicate-while-merging")) {
+        options.SetDeduplicateWhileMerging(true);
       } else if (0 == strcmp(cur_arg, "--help") || 0 == strcmp(cur_arg, "-h")) {
         print_usage(argv[0]);
         return 0;
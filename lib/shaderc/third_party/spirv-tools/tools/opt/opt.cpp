@@ -106,6 +106,12 @@ Options (in lexicographical order):)",
                Forwards this option to the validator.  See the validator help
                for details.)");
   printf(R"(
+  --cache-dir=<directory>
+               Keep optimized binaries in <directory>, found by the input,
+               the target environment, the options and the passes. Runs with
+               the same inputs and settings reuse them without optimizing
+               again.)");
+  printf(R"(
   --ccp
                Apply the conditional constant propagation transform.  This will
                propagate constant values throughout the program, and simplify
@@ -370,6 +376,10 @@ Options (in lexicographical order):)",
                Ensure that the optimizer preserves all specialization constants declared
                within the module, even when those constants are unused.)");
   printf(R"(
+  --parallel-functions
+               Analyze functions on multiple threads in the passes that
+               support it. The output is the same as without this option.)");
+  printf(R"(
   --print-all
                Print SPIR-V assembly to standard error output before each pass
                and after the last pass.)");
@@ -442,6 +452,11 @@ Options (in lexicographical order):)",
                Forwards this option to the validator.  See the validator help
                for details.)");
   printf(R"(
+  --skip-unchanged-passes
+               Skip a pass when a pass with the same name already ran without
+               changing the module, and no pass has changed it since. The
+               output is the same as without this option.)");
+  printf(R"(
   --skip-validation
                Will not validate the SPIR-V before optimizing.  If the SPIR-V
                is invalid, the optimizer may fail or generate incorrect code.
@@ -695,10 +710,18 @@ OptStatus ParseFlags(int argc, const char** argv,
         if (status.action != OPT_CONTINUE) {
           return status;
         }
+      } else if (0 == strncmp(cur_arg, "--cache-dir=",
+                              sizeof("--cache-dir=") - 1)) {
+        auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        optimizer->SetCacheDirectory(split_flag.second);
+      } else if (0 == strcmp(cur_arg, "--skip-unchanged-passes")) {
+        optimizer->SetSkipUnchangedPasses(true);
       } else if (0 == strcmp(cur_arg, "--skip-validation")) {
         optimizer_options->set_run_validator(false);
       } else if (0 == strcmp(cur_arg, "--print-all")) {
         optimizer->SetPrintAll(&std::cerr);
+      } else if (0 == strcmp(cur_arg, "--parallel-functions")) {
+        optimizer_options->set_parallel_functions(true);
       } else if (0 == strcmp(cur_arg, "--preserve-bindings")) {
         optimizer_options->set_preserve_bindings(true);
       } else if (0 == strcmp(cur_arg, "--preserve-spec-constants")) {
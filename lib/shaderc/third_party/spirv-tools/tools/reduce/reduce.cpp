@@ -100,6 +100,11 @@ Options (in lexicographical order):
                SPIR-V module that fails to validate.
   -h, --help
                Print this help.
+  --parallel-candidates=
+               32-bit unsigned integer specifying how many reduction steps may
+               be tried at once, each running the interestingness test on a
+               different temporary file.  The reduced binary is the same as
+               when trying one step at a time, which is the default.
   --step-limit=
                32-bit unsigned integer specifying maximum number of steps the
                reducer will take before giving up.
@@ -178,6 +183,15 @@ ReduceStatus ParseFlags(int argc, const char** argv,
             static_cast<uint32_t>(strtol(split_flag.second.c_str(), &end, 10));
         assert(end != split_flag.second.c_str() && errno == 0);
         reducer_options->set_step_limit(step_limit);
+      } else if (0 == strncmp(cur_arg, "--parallel-candidates=",
+                              sizeof("--parallel-candidates=") - 1)) {
+        const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        char* end = nullptr;
+        errno = 0;
+        const auto parallel_candidates =
+            static_cast<uint32_t>(strtol(split_flag.second.c_str(), &end, 10));
+        assert(end != split_flag.second.c_str() && errno == 0);
+        reducer_options->set_parallel_candidates(parallel_candidates);
       } else if (0 == strncmp(cur_arg, "--target-function=",
                               sizeof("--target-function=") - 1)) {
         const auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
@@ -66,6 +66,8 @@ Options:
                                    members.
   --before-hlsl-legalization       Allows code patterns that are intended to be
                                    fixed by spirv-opt's legalization passes.
+  --parallel                       Check function bodies on multiple threads.
+                                   Reports the same diagnostics as a serial run.
   --version                        Display validator version information.
   --target-env                     {%s}
                                    Use validation rules from the specified environment.
@@ -155,6 +157,8 @@ int main(int argc, char** argv) {
         options.SetSkipBlockLayout(true);
       } else if (0 == strcmp(cur_arg, "--relax-struct-store")) {
         options.SetRelaxStructStore(true);
+      } else if (0 == strcmp(cur_arg, "--parallel")) {
+        options.SetParallel(true);
       } else if (0 == cur_arg[1]) {
         // Setting a filename of "-" to indicate stdin.
         if (!inFile) {
@@ -366,7 +366,7 @@ string CompilerCPP::compile()
 	// Entry point in CPP is always main() for the time being.
 	get_entry_point().name = "main";
 
-	return buffer.str();
+	return get_compiled_source();
 }
 
 void CompilerCPP::emit_c_linkage()
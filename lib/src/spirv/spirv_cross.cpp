@@ -75,6 +75,13 @@ string Compiler::compile()
 	return "";
 }
 
+void Compiler::compile(const OutputSink &sink)
+{
+	auto source = compile();
+	if (!source.empty())
+		sink(source.data(), source.size());
+}
+
 bool Compiler::variable_storage_is_aliased(const SPIRVariable &v)
 {
 	auto &type = get<SPIRType>(v.basetype);
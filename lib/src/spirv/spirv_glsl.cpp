@@ -625,7 +625,36 @@ string CompilerGLSL::compile()
 	// Entry point in GLSL is always main().
 	get_entry_point().name = "main";
 
-	return buffer.str();
+	return get_compiled_source();
+}
+
+void CompilerGLSL::compile(const OutputSink &sink)
+{
+	struct StreamScope
+	{
+		explicit StreamScope(bool &flag_)
+		    : flag(flag_)
+		{
+			flag = true;
+		}
+		~StreamScope()
+		{
+			flag = false;
+		}
+		bool &flag;
+	};
+
+	{
+		// Virtual dispatch picks the actual backend, which leaves its output in buffer.
+		StreamScope scope(stream_output);
+		compile();
+	}
+	buffer.for_each_block(sink);
+}
+
+std::string CompilerGLSL::get_compiled_source() const
+{
+	return stream_output ? std::string() : buffer.str();
 }
 
 std::string CompilerGLSL::get_partial_source()
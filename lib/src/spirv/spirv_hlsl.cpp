@@ -5754,7 +5754,7 @@ string CompilerHLSL::compile()
 	// Entry point in HLSL is always main() for the time being.
 	get_entry_point().name = "main";
 
-	return buffer.str();
+	return get_compiled_source();
 }
 
 void CompilerHLSL::emit_block_hints(const SPIRBlock &block)
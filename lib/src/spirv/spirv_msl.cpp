@@ -1331,7 +1331,7 @@ string CompilerMSL::compile()
 		pass_count++;
 	} while (is_forcing_recompilation());
 
-	return buffer.str();
+	return get_compiled_source();
 }
 
 // Register the need to output any custom functions.
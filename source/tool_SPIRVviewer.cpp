@@ -26,6 +26,11 @@
 #include <algorithm>
 #include <string>
 #include <fstream>
+#include <future>
+#include <chrono>
+#include <sstream>
+#include <spirv-tools/libspirv.hpp>
+#include <spirv-tools/optimizer.hpp>
 
 using namespace std;
 
@@ -46,6 +51,8 @@ static int activeDesclayoutItem = 0;
 static int activeDescBindingItem = 0;
 
 static ImVec4 favColor = ImVec4(0.067f, 0.765f, 0.941f, 1.0f);
+static ImVec4 errorColor = ImVec4(0.953f, 0.208f, 0.42f, 1.0f);
+static ImVec4 warningColor = ImVec4(0.941f, 0.765f, 0.067f, 1.0f);
 
 // -------------------------------------------------------- Helpers -----------------------------------------------
 
@@ -210,6 +217,18 @@ void shaderTool_t::DrawMenu()
 					this->Save(p);
 				}
 			}
+			if (ImGui::MenuItem("Export sources..", NULL, nullptr, !shaderModules.empty())) {
+				string p;
+				if (saveDialog(p, nullptr)) {
+					this->ExportSources(p);
+				}
+			}
+			if (ImGui::MenuItem("Export reflection..", NULL, nullptr, !shaderModules.empty())) {
+				string p;
+				if (saveDialog(p, "json")) {
+					this->ExportReflection(p);
+				}
+			}
 			ImGui::Separator();
 			if (ImGui::MenuItem("Exit", NULL, nullptr)) {
 				exit(0);
@@ -300,206 +319,269 @@ void shaderTool_t::DrawShaderTypes()
 			break;
 		}
 
+		//modules SPIRV-Cross gave up on still get a button so their errors can be looked at
+		case shaderModule_t::unknown:
+		{
+			if (ImGui::Button("unknown"))
+			{
+				currentModule = moduleIter;
+			}
+			break;
+		}
+
 		default:
 			break;
 		}
 	}
 }
 
-void shaderTool_t::DrawShaderReflection()
+void shaderTool_t::DrawSpecConstants()
 {
-	if (!shaderModules.empty())
+	if (shaderModules.empty() || shaderModules[currentModule].specConstants.empty())
 	{
-		ImGui::BeginChild("reflection info");
-		ImGui::TextColored(favColor, "%s:", "Shader reflection info");
-		//fill out the reflection info for the shader
-
-		ImGui::Text("GLSL Version: %i", shaderModules[currentModule].shaderOptions.version);
-		ImGui::Text((std::string("Uses OpenGL ES: ") + (shaderModules[currentModule].shaderOptions.es ? "true" : "false")).c_str());
-		//ImGui::Text("float precision", shaderOptions.fragment.default_float_precision)
-
-		shaderModules[currentModule].intPrecision = "integer precision: ";
-		shaderModules[currentModule].floatPrecision = "Floating point precision: ";
+		return;
+	}
 
-		switch (shaderModules[currentModule].shaderOptions.fragment.default_float_precision)
+	static const char* workGroupAxes[3] = { "local_size_x", "local_size_y", "local_size_z" };
+	shaderModule_t& module = shaderModules[currentModule];
+	ImGui::TextColored(favColor, "%s:", "Specialization constants");
+	for (specConstant_t& constant : module.specConstants)
+	{
+		ImGui::PushID((int)constant.constantID);
+		if (constant.workGroupAxis >= 0)
 		{
-		case spirv_cross::CompilerGLSL::Options::Highp:
+			ImGui::Text("constant_id %u (%s) %s", constant.constantID, workGroupAxes[constant.workGroupAxis], constant.name.c_str());
+		}
+		else
 		{
-			shaderModules[currentModule].floatPrecision += "high";
-			break;
+			ImGui::Text("constant_id %u %s", constant.constantID, constant.name.c_str());
 		}
 
-		case spirv_cross::CompilerGLSL::Options::Mediump:
+		bool changed = false;
+		switch (constant.baseType)
 		{
-			shaderModules[currentModule].floatPrecision += "medium";
+		case spirv_cross::SPIRType::Boolean:
+		{
+			bool value = constant.value.u32 != 0;
+			changed = ImGui::Checkbox("##value", &value);
+			constant.value.u32 = value ? 1 : 0;
 			break;
 		}
 
-		case spirv_cross::CompilerGLSL::Options::Lowp:
-		{
-			shaderModules[currentModule].floatPrecision += "low";
+		case spirv_cross::SPIRType::Int:
+			changed = ImGui::InputScalar("##value", ImGuiDataType_S32, &constant.value.i32, nullptr, nullptr, nullptr, ImGuiInputTextFlags_EnterReturnsTrue);
 			break;
-		}
 
-		default:
-		{
-			shaderModules[currentModule].floatPrecision += "N/A";
+		case spirv_cross::SPIRType::UInt:
+			changed = ImGui::InputScalar("##value", ImGuiDataType_U32, &constant.value.u32, nullptr, nullptr, nullptr, ImGuiInputTextFlags_EnterReturnsTrue);
 			break;
-		}
-		}
-		ImGui::Text("%s", shaderModules[currentModule].floatPrecision.c_str());
 
-		switch (shaderModules[currentModule].shaderOptions.fragment.default_int_precision)
-		{
-		case spirv_cross::CompilerGLSL::Options::Highp:
-		{
-			shaderModules[currentModule].intPrecision += "high";
+		case spirv_cross::SPIRType::Int64:
+			changed = ImGui::InputScalar("##value", ImGuiDataType_S64, &constant.value.i64, nullptr, nullptr, nullptr, ImGuiInputTextFlags_EnterReturnsTrue);
 			break;
-		}
 
-		case spirv_cross::CompilerGLSL::Options::Mediump:
-		{
-			shaderModules[currentModule].intPrecision += "medium";
+		case spirv_cross::SPIRType::UInt64:
+			changed = ImGui::InputScalar("##value", ImGuiDataType_U64, &constant.value.u64, nullptr, nullptr, nullptr, ImGuiInputTextFlags_EnterReturnsTrue);
 			break;
-		}
 
-		case spirv_cross::CompilerGLSL::Options::Lowp:
-		{
-			shaderModules[currentModule].intPrecision += "low";
+		case spirv_cross::SPIRType::Float:
+			changed = ImGui::InputScalar("##value", ImGuiDataType_Float, &constant.value.f32, nullptr, nullptr, "%g", ImGuiInputTextFlags_EnterReturnsTrue);
+			break;
+
+		case spirv_cross::SPIRType::Double:
+			changed = ImGui::InputScalar("##value", ImGuiDataType_Double, &constant.value.f64, nullptr, nullptr, "%g", ImGuiInputTextFlags_EnterReturnsTrue);
 			break;
-		}
 
 		default:
-		{
-			shaderModules[currentModule].intPrecision += "N/A";
+			//8/16 bit and half constants are shown but not editable
+			ImGui::Text("raw value: 0x%08x", constant.value.u32);
 			break;
 		}
-		}
-		ImGui::Text("%s", shaderModules[currentModule].intPrecision.c_str());
-		ImGui::Separator();
-		ImGui::Spacing();
-
 
-		//atomic counters
-		ImGui::TextColored(favColor, "Atomics Info:");
-		for (unsigned int atomicIndex = 0; atomicIndex < shaderModules[currentModule].shaderResources.atomic_counters.size(); atomicIndex++)
+		if (changed)
 		{
-			ImGui::Text("Atomic %i", atomicIndex);
-			ImGui::Text("Atomic ID: %i", shaderModules[currentModule].shaderResources.atomic_counters[atomicIndex].id);
-			ImGui::Text("Atomic name: %s", shaderModules[currentModule].shaderResources.atomic_counters[atomicIndex].name.c_str());
-			ImGui::Text("Atomic type ID: %i", shaderModules[currentModule].shaderResources.atomic_counters[atomicIndex].type_id);
-			ImGui::Spacing();
+			ApplySpecConstant(module, constant);
 		}
-		ImGui::Separator();
-		ImGui::Spacing();
+		ImGui::PopID();
+	}
+	ImGui::Separator();
+	ImGui::Spacing();
+}
 
-		//push constant buffers // look this up!
-		ImGui::TextColored(favColor, "Push constant buffers:");
-		for (unsigned int pushIndex = 0; pushIndex < shaderModules[currentModule].shaderResources.push_constant_buffers.size(); pushIndex++)
+void shaderTool_t::DrawShaderReflection()
+{
+	if (!shaderModules.empty())
+	{
+		const reflectionModel_t& reflection = shaderModules[currentModule].reflection;
+		ImGui::BeginChild("reflection info", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+		ImGui::TextColored(favColor, "%s:", "Shader reflection info");
+		//fill out the reflection info for the shader
+		for (const std::string& line : reflection.summary)
 		{
-			ImGui::Text("Push constant %i", pushIndex);
-			ImGui::Text("Push constant ID: %i", shaderModules[currentModule].shaderResources.push_constant_buffers[pushIndex].id);
-			ImGui::Text("Push constant name: %s", shaderModules[currentModule].shaderResources.push_constant_buffers[pushIndex].name.c_str());
-			ImGui::Text("Push constant type ID: %i", shaderModules[currentModule].shaderResources.push_constant_buffers[pushIndex].type_id);
-			ImGui::Spacing();
+			ImGui::TextUnformatted(line.c_str());
 		}
 		ImGui::Separator();
 		ImGui::Spacing();
 
-		//sampled images
-		ImGui::TextColored(favColor, "Sampled images:");
-		for (unsigned int sampleIndex = 0; sampleIndex < shaderModules[currentModule].shaderResources.sampled_images.size(); sampleIndex++)
+		static const char* columnNames[reflectionRow_t::numColumns] = { "#", "ID", "Name", "Type", "Binding" };
+		const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit;
+		for (const reflectionCategory_t& category : reflection.categories)
 		{
-			ImGui::Text("Sample %i", sampleIndex);
-			ImGui::Text("Sample ID: %i", shaderModules[currentModule].shaderResources.sampled_images[sampleIndex].id);
-			ImGui::Text("Sample name: %s", shaderModules[currentModule].shaderResources.sampled_images[sampleIndex].name.c_str());
-			ImGui::Text("Sample type ID: %i", shaderModules[currentModule].shaderResources.sampled_images[sampleIndex].type_id);
-			ImGui::Spacing();
-		}
-		ImGui::Separator();
-		ImGui::Spacing();
+			ImGui::PushStyleColor(ImGuiCol_Text, favColor);
+			bool open = ImGui::CollapsingHeader(category.title.c_str(), ImGuiTreeNodeFlags_DefaultOpen);
+			ImGui::PopStyleColor();
+			if (!open || category.rowCount == 0)
+			{
+				continue;
+			}
 
-		//shader stage inputs
-		ImGui::TextColored(favColor, "Stage inputs:");
-		for (unsigned int inputIndex = 0; inputIndex < shaderModules[currentModule].shaderResources.stage_inputs.size(); inputIndex++)
-		{
-			ImGui::Text("Input %i", inputIndex);
-			ImGui::Text("Input ID: %i", shaderModules[currentModule].shaderResources.stage_inputs[inputIndex].id);
-			ImGui::Text("Input name: %s", shaderModules[currentModule].shaderResources.stage_inputs[inputIndex].name.c_str());
-			ImGui::Text("Input type ID: %i", shaderModules[currentModule].shaderResources.stage_inputs[inputIndex].type_id);
+			if (ImGui::BeginTable(category.title.c_str(), reflectionRow_t::numColumns, tableFlags))
+			{
+				for (const char* columnName : columnNames)
+				{
+					ImGui::TableSetupColumn(columnName);
+				}
+				ImGui::TableHeadersRow();
+
+				//only the rows that are scrolled into view get submitted
+				ImGuiListClipper clipper;
+				clipper.Begin((int)category.rowCount);
+				while (clipper.Step())
+				{
+					for (int rowIter = clipper.DisplayStart; rowIter < clipper.DisplayEnd; rowIter++)
+					{
+						const reflectionRow_t& row = reflection.rows[category.firstRow + rowIter];
+						const reflectedResource_t& resource = shaderModules[currentModule].reflectionIndex.resources[row.resource];
+						ImGui::TableNextRow();
+						ImGui::TableSetColumnIndex(0);
+						if (resource.memberCount > 0)
+						{
+							//blocks open their member layout in a separate window
+							ImGui::PushID((int)row.resource);
+							if (ImGui::Selectable(row.columns[0].c_str(), layoutModule == (int)currentModule && layoutResource == (int)row.resource,
+								ImGuiSelectableFlags_SpanAllColumns))
+							{
+								layoutModule = (int)currentModule;
+								layoutResource = (int)row.resource;
+								layoutFilter[0] = '\0';
+								shaderModules[currentModule].reflectionIndex.SearchMembers(row.resource, std::string(), layoutMatches);
+							}
+							ImGui::PopID();
+						}
+						else
+						{
+							ImGui::TextUnformatted(row.columns[0].c_str());
+						}
+						for (unsigned int columnIter = 1; columnIter < reflectionRow_t::numColumns; columnIter++)
+						{
+							ImGui::TableSetColumnIndex(columnIter);
+							ImGui::TextUnformatted(row.columns[columnIter].c_str());
+						}
+					}
+				}
+				ImGui::EndTable();
+			}
 			ImGui::Spacing();
 		}
-		ImGui::Separator();
-		ImGui::Spacing();
 
-		//shader stage outputs
-		ImGui::TextColored(favColor, "Stage outputs:");
-		for (unsigned int outputIndex = 0; outputIndex < shaderModules[currentModule].shaderResources.stage_outputs.size(); outputIndex++)
-		{
-			ImGui::Text("Output %i", outputIndex);
-			ImGui::Text("Output ID: %i", shaderModules[currentModule].shaderResources.stage_outputs[outputIndex].id);
-			ImGui::Text("Output name: %s", shaderModules[currentModule].shaderResources.stage_outputs[outputIndex].name.c_str());
-			ImGui::Text("Output type ID: %i", shaderModules[currentModule].shaderResources.stage_outputs[outputIndex].type_id);
-			ImGui::Spacing();
-		}
-		ImGui::Separator();
-		ImGui::Spacing();
+		ImGui::EndChild(); //reflection info
+	}
+}
 
-		//shader storage buffers
-		ImGui::TextColored(favColor, "Storage buffers:");
-		for (unsigned int storageIndex = 0; storageIndex < shaderModules[currentModule].shaderResources.storage_buffers.size(); storageIndex++)
-		{
-			ImGui::Text("Storage buffer %i", storageIndex);
-			ImGui::Text("Storage buffer ID: %i", shaderModules[currentModule].shaderResources.storage_buffers[storageIndex].id);
-			ImGui::Text("Storage buffer name: %s", shaderModules[currentModule].shaderResources.storage_buffers[storageIndex].name.c_str());
-			ImGui::Text("Storage buffer type ID: %i", shaderModules[currentModule].shaderResources.storage_buffers[storageIndex].type_id);
-			ImGui::Spacing();
-		}
-		ImGui::Separator();
-		ImGui::Spacing();
+void shaderTool_t::DrawBlockLayout()
+{
+	if (layoutResource < 0 || layoutModule != (int)currentModule || shaderModules.empty())
+	{
+		return;
+	}
 
-		//shader storage images? //need to look that one up 
-		//i think these can be written to (similar to render targets)
-		ImGui::TextColored(favColor, "Storage images:");
-		for (unsigned int imageIndex = 0; imageIndex < shaderModules[currentModule].shaderResources.storage_images.size(); imageIndex++)
+	const reflectionIndex_t& index = shaderModules[currentModule].reflectionIndex;
+	const reflectedResource_t& resource = index.resources[layoutResource];
+	bool open = true;
+	ImGui::SetNextWindowSize(ImVec2(700, 500), ImGuiCond_FirstUseEver);
+	if (ImGui::Begin("Block layout", &open))
+	{
+		ImGui::TextColored(favColor, "%s (%s)", resource.name.c_str(), reflectionIndex_t::KindName(resource.kind));
+		ImGui::Text("declared size: %u bytes, %u members", resource.size, resource.memberCount);
+		if (ImGui::InputText("filter", layoutFilter, sizeof(layoutFilter)))
 		{
-			ImGui::Text("Storage image %i", imageIndex);
-			ImGui::Text("Storage image ID: %i", shaderModules[currentModule].shaderResources.storage_images[imageIndex].id);
-			ImGui::Text("Storage image name: %s", shaderModules[currentModule].shaderResources.storage_images[imageIndex].name.c_str());
-			ImGui::Text("Storage image type ID: %i", shaderModules[currentModule].shaderResources.storage_images[imageIndex].type_id);
-			ImGui::Spacing();
+			index.SearchMembers((uint32_t)layoutResource, layoutFilter, layoutMatches);
 		}
 		ImGui::Separator();
-		ImGui::Spacing();
 
-		//shader sub pass inputs
-		ImGui::TextColored(favColor, "Sub pass inputs:");
-		for (unsigned int subpassIndex = 0; subpassIndex < shaderModules[currentModule].shaderResources.storage_images.size(); subpassIndex++)
+		static const char* columnNames[] = { "Member", "Type", "Offset", "Size", "Array stride", "Matrix stride" };
+		const ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY |
+			ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit;
+		if (ImGui::BeginTable("members", IM_ARRAYSIZE(columnNames), tableFlags))
 		{
-			ImGui::Text("Sub pass input %i", subpassIndex);
-			ImGui::Text("Sub pass input ID: %i", shaderModules[currentModule].shaderResources.subpass_inputs[subpassIndex].id);
-			ImGui::Text("Sub pass input name: %s", shaderModules[currentModule].shaderResources.subpass_inputs[subpassIndex].name.c_str());
-			ImGui::Text("Sub pass input type ID: %i", shaderModules[currentModule].shaderResources.subpass_inputs[subpassIndex].type_id);
-			ImGui::Spacing();
+			ImGui::TableSetupScrollFreeze(0, 1);
+			for (const char* columnName : columnNames)
+			{
+				ImGui::TableSetupColumn(columnName);
+			}
+			ImGui::TableHeadersRow();
+
+			ImGuiListClipper clipper;
+			clipper.Begin((int)layoutMatches.size());
+			while (clipper.Step())
+			{
+				for (int rowIter = clipper.DisplayStart; rowIter < clipper.DisplayEnd; rowIter++)
+				{
+					const blockMember_t& member = index.members[layoutMatches[rowIter]];
+					ImGui::TableNextRow();
+					ImGui::TableSetColumnIndex(0);
+					float indent = member.depth * ImGui::GetStyle().IndentSpacing;
+					if (indent > 0.0f)
+						ImGui::Indent(indent);
+					ImGui::TextUnformatted(member.name.c_str());
+					if (indent > 0.0f)
+						ImGui::Unindent(indent);
+					ImGui::TableSetColumnIndex(1);
+					ImGui::TextUnformatted(member.typeName.c_str());
+					ImGui::TableSetColumnIndex(2);
+					ImGui::Text("%u", member.offset);
+					ImGui::TableSetColumnIndex(3);
+					ImGui::Text("%u", member.size);
+					ImGui::TableSetColumnIndex(4);
+					ImGui::Text("%u", member.arrayStride);
+					ImGui::TableSetColumnIndex(5);
+					ImGui::Text("%u", member.matrixStride);
+				}
+			}
+			ImGui::EndTable();
 		}
-		ImGui::Separator();
-		ImGui::Spacing();
+	}
+	ImGui::End();
 
-		//shader uniform buffers
-		ImGui::TextColored(favColor, "Uniform buffers:");
-		for (unsigned int uniformIndex = 0; uniformIndex < shaderModules[currentModule].shaderResources.storage_images.size(); uniformIndex++)
+	if (!open)
+	{
+		layoutResource = -1;
+	}
+}
+
+void shaderTool_t::DrawValidation()
+{
+	const shaderModule_t& module = shaderModules[currentModule];
+	if (!module.compileError.empty())
+	{
+		ImGui::TextColored(errorColor, "SPIRV-Cross: %s", module.compileError.c_str());
+	}
+	if (!module.validation || module.validation->messages.empty())
+	{
+		return;
+	}
+
+	ImGui::TextColored(module.validation->valid ? warningColor : errorColor, "Validation: %u message(s)", (unsigned int)module.validation->messages.size());
+	for (const validationMessage_t& message : module.validation->messages)
+	{
+		const ImVec4& color = message.error ? errorColor : warningColor;
+		ImGui::TextColored(color, "%s", message.text.c_str());
+		if (!message.instruction.empty())
 		{
-			ImGui::Text("Uniform buffer %i", uniformIndex);
-			ImGui::Text("Uniform buffer ID: %i", shaderModules[currentModule].shaderResources.uniform_buffers[uniformIndex].id);
-			ImGui::Text("Uniform buffer name: %s", shaderModules[currentModule].shaderResources.uniform_buffers[uniformIndex].name.c_str());
-			ImGui::Text("Uniform buffer type ID: %i", shaderModules[currentModule].shaderResources.uniform_buffers[uniformIndex].type_id);
-			ImGui::Spacing();
+			ImGui::TextColored(color, "\t%s", message.instruction.c_str());
 		}
-		ImGui::Separator();
-		ImGui::Spacing();
-
-		ImGui::EndChild(); //reflection info
 	}
+	ImGui::Separator();
 }
 
 void shaderTool_t::DrawSPIRV(ImVec2 dimensions)
@@ -510,6 +592,7 @@ void shaderTool_t::DrawSPIRV(ImVec2 dimensions)
 		ImGui::SetScrollX(10.0f);
 		ImGui::TextColored(favColor, "%s:", "\t SPIRV source code");
 		ImGui::Separator();
+		DrawValidation();
 		//add open in in editor button and open in vim button
 		ImGui::InputTextMultiline("##", (char*)shaderModules[currentModule].spirvSource.c_str(), shaderModules[currentModule].spirvSource.size() * sizeof(char), dimensions, ImGuiInputTextFlags_ReadOnly);
 
@@ -544,6 +627,170 @@ void shaderTool_t::DrawMSL(ImVec2 dimensions)
 	}
 }
 
+void shaderTool_t::DrawPassReport(const optimizedModule_t& optimized, float height)
+{
+	static const char* columns[] = { "#", "Pass", "Wall ms", "CPU ms", "RSS KB", "Instructions", "Change" };
+	const std::vector<passReport_t>& passes = optimized.passes;
+
+	//keep the row order across frames, it only has to be rebuilt for a new report
+	bool sortRows = false;
+	if (passOrderSource != &optimized || passOrder.size() != passes.size())
+	{
+		passOrder.resize(passes.size());
+		for (size_t passIter = 0; passIter < passes.size(); passIter++)
+		{
+			passOrder[passIter] = (int)passIter;
+		}
+		passOrderSource = &optimized;
+		sortRows = true;
+	}
+
+	ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+	if (!ImGui::BeginTable("##passes", IM_ARRAYSIZE(columns), flags, ImVec2(0.0f, height)))
+	{
+		return;
+	}
+
+	ImGui::TableSetupScrollFreeze(0, 1);
+	for (const char* column : columns)
+	{
+		ImGui::TableSetupColumn(column, column == columns[1] ? ImGuiTableColumnFlags_WidthStretch : ImGuiTableColumnFlags_WidthFixed);
+	}
+	ImGui::TableHeadersRow();
+
+	ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+	if (sortSpecs != nullptr && sortSpecs->SpecsCount > 0 && (sortSpecs->SpecsDirty || sortRows))
+	{
+		const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+		const bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+		auto key = [&passes, &spec](int pass) -> double
+		{
+			const passReport_t& report = passes[pass];
+			switch (spec.ColumnIndex)
+			{
+			case 2: return report.wallTime;
+			case 3: return report.cpuTime;
+			case 4: return (double)report.rssDelta;
+			case 5: return report.instructionsAfter;
+			case 6: return (double)report.instructionsAfter - report.instructionsBefore;
+			default: return pass;
+			}
+		};
+		std::stable_sort(passOrder.begin(), passOrder.end(), [&](int left, int right)
+		{
+			if (spec.ColumnIndex == 1 && passes[left].name != passes[right].name)
+			{
+				return ascending == (passes[left].name < passes[right].name);
+			}
+			return ascending ? key(left) < key(right) : key(right) < key(left);
+		});
+		sortSpecs->SpecsDirty = false;
+	}
+
+	ImGuiListClipper clipper;
+	clipper.Begin((int)passOrder.size());
+	while (clipper.Step())
+	{
+		for (int rowIter = clipper.DisplayStart; rowIter < clipper.DisplayEnd; rowIter++)
+		{
+			const passReport_t& pass = passes[passOrder[rowIter]];
+			const bool timed = pass.wallTime >= 0.0;
+			const bool counted = pass.instructionsBefore >= 0 && pass.instructionsAfter >= 0;
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", passOrder[rowIter] + 1);
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(pass.name.c_str());
+			ImGui::TableNextColumn();
+			timed ? ImGui::Text("%.3f", pass.wallTime * 1000.0) : ImGui::TextDisabled("n/a");
+			ImGui::TableNextColumn();
+			pass.cpuTime >= 0.0 ? ImGui::Text("%.3f", pass.cpuTime * 1000.0) : ImGui::TextDisabled("n/a");
+			ImGui::TableNextColumn();
+			timed ? ImGui::Text("%ld", pass.rssDelta) : ImGui::TextDisabled("n/a");
+			ImGui::TableNextColumn();
+			counted ? ImGui::Text("%d", pass.instructionsAfter) : ImGui::TextDisabled("n/a");
+			ImGui::TableNextColumn();
+			if (!counted)
+			{
+				ImGui::TextDisabled("n/a");
+			}
+			else if (pass.instructionsAfter != pass.instructionsBefore)
+			{
+				ImGui::TextColored(pass.instructionsAfter < pass.instructionsBefore ? favColor : warningColor, "%+d", pass.instructionsAfter - pass.instructionsBefore);
+			}
+			else
+			{
+				ImGui::TextDisabled("0");
+			}
+		}
+	}
+	ImGui::EndTable();
+}
+
+void shaderTool_t::DrawOptimized(ImVec2 dimensions)
+{
+	if (shaderModules.empty())
+	{
+		return;
+	}
+
+	static const char* recipes[optimizedModule_t::numRecipes] = { "Performance", "Size", "Legalization", "Custom" };
+	static const char* views[] = { "SPIR-V", "GLSL", "HLSL", "MSL" };
+	static const ShaderType viewTypes[] = { UNKNOWN_TYPE, GLSL_TYPE, HLSL_TYPE, MSL_TYPE };
+
+	ImGui::PushItemWidth(150.0f);
+	ImGui::Combo("Recipe", &optimizerRecipe, recipes, IM_ARRAYSIZE(recipes));
+	ImGui::PopItemWidth();
+	if (optimizerRecipe == optimizedModule_t::custom)
+	{
+		ImGui::InputTextWithHint("##customPasses", "--merge-return --eliminate-dead-code-aggressive ...", customPasses, sizeof(customPasses));
+	}
+	ImGui::Checkbox("Count instructions per pass", &countInstructions);
+	ImGui::SameLine();
+
+	if (pendingOptimization.valid())
+	{
+		ImGui::TextColored(warningColor, "Optimizing...");
+	}
+	else if (ImGui::Button("Optimize"))
+	{
+		StartOptimization();
+	}
+
+	const shaderModule_t& module = shaderModules[currentModule];
+	if (!module.optimized)
+	{
+		return;
+	}
+
+	const optimizedModule_t& optimized = *module.optimized;
+	ImGui::Separator();
+	if (optimized.succeeded)
+	{
+		ImGui::TextColored(favColor, "%u -> %u words, %u passes in %.1f ms", (unsigned int)module.binaryList.size(),
+			(unsigned int)optimized.binary.size(), (unsigned int)optimized.passes.size(), optimized.wallTime * 1000.0);
+	}
+	else
+	{
+		ImGui::TextColored(errorColor, "Optimization failed");
+	}
+	if (!optimized.messages.empty())
+	{
+		ImGui::TextColored(warningColor, "%s", optimized.messages.c_str());
+	}
+
+	DrawPassReport(optimized, dimensions.y * 0.35f);
+
+	ImGui::PushItemWidth(150.0f);
+	ImGui::Combo("View", &optimizedView, views, IM_ARRAYSIZE(views));
+	ImGui::PopItemWidth();
+	const ShaderType viewType = viewTypes[optimizedView];
+	const std::string& source = viewType == UNKNOWN_TYPE ? optimized.spirvSource : optimized.sources[viewType];
+	ImGui::InputTextMultiline("##optimizedSource", (char*)source.c_str(), source.size() * sizeof(char), ImVec2(-1.0f, -1.0f), ImGuiInputTextFlags_ReadOnly);
+}
+
 void shaderTool_t::Render(int screenWidth, int screenHeight)
 {
 	ImGui::SetNextWindowPos(ImVec2(4, 4));
@@ -555,6 +802,7 @@ void shaderTool_t::Render(int screenWidth, int screenHeight)
 		ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_HorizontalScrollbar;
 	ImGui::Begin("Main window", nullptr, windowFlags);
 	ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 0.8f));
+	PollOptimization();
 	//ImGui::ShowStyleEditor();
 	{
 		// --------------------------- Menu bar ---------------------------------
@@ -571,9 +819,11 @@ void shaderTool_t::Render(int screenWidth, int screenHeight)
 		ImGui::Separator();
 		DrawShaderTypes();
 		ImGui::Separator();
+		DrawSpecConstants();
 		//add reflection info to the bottom
 		DrawShaderReflection();
 		ImGui::EndChild(); // column 1
+		DrawBlockLayout();
 		ImGui::SameLine();
 
 		//get the size of the window the halve it for the children
@@ -601,17 +851,28 @@ void shaderTool_t::Render(int screenWidth, int screenHeight)
 		}
 		if (currentItem != nullptr) {
 			std::string debug_currentItem(currentItem);
+			//the optimized view keeps the last target so switching back doesn't re-emit anything
+			showOptimized = debug_currentItem == "Optimized";
 			if (debug_currentItem == "GLSL source code")
 				shaderType = GLSL_TYPE;
 			else if (debug_currentItem == "HLSL source code")
 				shaderType = HLSL_TYPE;
 			else if (debug_currentItem == "MSL source code")
 				shaderType = MSL_TYPE;
-			else
+			else if (!showOptimized)
 				shaderType = UNKNOWN_TYPE;
 		}
 		ImGui::Separator();
-		switch (shaderType)
+		if (showOptimized)
+		{
+			DrawOptimized(newDimensions);
+		}
+		//specialization constant edits only mark sources stale, re-emit the one being looked at
+		else if (!shaderModules.empty() && shaderType != UNKNOWN_TYPE && shaderModules[currentModule].staleSources[shaderType])
+		{
+			EmitSource(shaderModules[currentModule], shaderType);
+		}
+		switch (showOptimized ? UNKNOWN_TYPE : shaderType)
 		{
 		case HLSL_TYPE:
 			DrawHLSL(newDimensions);
@@ -645,48 +906,757 @@ void shaderTool_t::Save(std::string fileName)
     }
 }
 
+void shaderTool_t::ExportReflection(std::string fileName)
+{
+	if (fileName.length() <= 0 || shaderModules.empty())
+	{
+		return;
+	}
+	if (!EndsWith(fileName, ".json"))
+	{
+		fileName += ".json";
+	}
+
+	std::ofstream file(fileName);
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open export file: %s\n", fileName.c_str());
+		return;
+	}
+
+	Json::StreamWriterBuilder builder;
+	builder["indentation"] = "\t";
+	std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+	writer->write(shaderModules[currentModule].reflectionIndex.ToJson(), &file);
+	file << "\n";
+}
+
+//the header version picks the environment, so newer instructions are accepted and older modules aren't held to newer rules
+static spv_target_env TargetEnvironment(const std::vector<uint32_t>& binary)
+{
+	static const spv_target_env environments[] = { SPV_ENV_UNIVERSAL_1_0, SPV_ENV_UNIVERSAL_1_1, SPV_ENV_UNIVERSAL_1_2,
+		SPV_ENV_UNIVERSAL_1_3, SPV_ENV_UNIVERSAL_1_4, SPV_ENV_UNIVERSAL_1_5 };
+	const uint32_t minor = binary.size() > 1 ? (binary[1] >> 8) & 0xff : 0;
+	return environments[std::min<uint32_t>(minor, IM_ARRAYSIZE(environments) - 1)];
+}
+
+//FNV-1a over the words of a binary
+static uint64_t HashBinary(const std::vector<uint32_t>& binary)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (uint32_t word : binary)
+	{
+		hash = (hash ^ word) * 1099511628211ull;
+	}
+	return hash;
+}
+
+//the text of every instruction in a disassembly, skipping blank and comment lines
+static std::vector<std::string> InstructionTexts(const std::string& disassembly)
+{
+	std::vector<std::string> texts;
+	size_t lineStart = 0;
+	while (lineStart < disassembly.size())
+	{
+		size_t lineEnd = disassembly.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+		{
+			lineEnd = disassembly.size();
+		}
+		size_t first = disassembly.find_first_not_of(" \t\r", lineStart);
+		if (first < lineEnd && disassembly[first] != ';')
+		{
+			texts.push_back(disassembly.substr(first, lineEnd - first));
+		}
+		lineStart = lineEnd + 1;
+	}
+	return texts;
+}
+
+//runs on its own thread while SPIRV-Cross parses the same binary, so it must not touch the module
+static std::shared_ptr<const validationResult_t> ValidateBinary(const std::vector<uint32_t>& binary)
+{
+	std::shared_ptr<validationResult_t> result = std::make_shared<validationResult_t>();
+	result->wordCount = binary.size();
+
+	//the validator points at instructions by their 1-based position in the module, 0 if there is none
+	std::vector<size_t> instructions;
+	const spv_target_env environment = TargetEnvironment(binary);
+	spvtools::Context context(environment);
+	context.SetMessageConsumer([&result, &instructions](spv_message_level_t level, const char*, const spv_position_t& position, const char* message)
+	{
+		validationMessage_t entry = {};
+		entry.text = message;
+		entry.error = level <= SPV_MSG_ERROR;
+		result->messages.push_back(std::move(entry));
+		instructions.push_back(position.index);
+	});
+
+	//go through the C API, SpirvTools::Validate reports the final error to the consumer a second time
+	spvtools::ValidatorOptions options;
+	options.SetParallel(true);
+	spv_const_binary_t constBinary = { binary.data(), binary.size() };
+	result->valid = spvValidateWithOptions(context.CContext(), options, &constBinary, nullptr) == SPV_SUCCESS;
+
+	//only the instructions the messages are about are kept, not the whole disassembly
+	spvtools::SpirvTools tools(environment);
+	std::string disassembly;
+	if (!result->messages.empty() && tools.Disassemble(binary, &disassembly, SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES))
+	{
+		std::vector<std::string> texts = InstructionTexts(disassembly);
+		for (size_t messageIter = 0; messageIter < result->messages.size(); messageIter++)
+		{
+			if (instructions[messageIter] > 0 && instructions[messageIter] <= texts.size())
+			{
+				result->messages[messageIter].instruction = texts[instructions[messageIter] - 1];
+			}
+		}
+	}
+	return result;
+}
+
+//the vulkan semantics every target is emitted with, plus the shader model HLSL is emitted for
+static void ConfigureTarget(spirv_cross::CompilerGLSL& compiler, ShaderType type)
+{
+	spirv_cross::CompilerGLSL::Options commonOptions = compiler.get_common_options();
+	commonOptions.vulkan_semantics = true;
+	compiler.set_common_options(commonOptions);
+
+	if (type == HLSL_TYPE)
+	{
+		spirv_cross::CompilerHLSL::Options hlslOptions;
+		hlslOptions.shader_model = 50;
+		static_cast<spirv_cross::CompilerHLSL&>(compiler).set_hlsl_options(hlslOptions);
+	}
+}
+
+static const char* targetNames[UNKNOWN_TYPE] = { "HLSL", "GLSL", "MSL" };
+
+//keeps every message when more than one target gives up
+static void RecordCompileError(shaderModule_t& module, const char* target, const std::exception& error)
+{
+	const std::string message = std::string(target) + ": " + error.what();
+	if (module.compileError.find(message) != std::string::npos)
+	{
+		return; //a target that keeps failing on re-emission says so once
+	}
+	if (!module.compileError.empty())
+	{
+		module.compileError += "\n";
+	}
+	module.compileError += message;
+}
+
 void shaderTool_t::CompileAll(std::vector<uint32_t>& spv, shaderModule_t& module)
 {
-	// GLSL
-	spirv_cross::CompilerGLSL glsl(spv);
-	module.shaderResources = glsl.get_shader_resources();
-	module.shaderOptions = glsl.get_common_options();
-	module.shaderOptions.vulkan_semantics = true;
-	glsl.set_common_options(module.shaderOptions);
-	module.glslSource = glsl.compile();
-	if (!module.glslSource.empty())
-		module.glslSource += "\n";
-	DetermineShaderModuleType(module, glsl.get_execution_model());
-
-	// HLSL
-	spirv_cross::CompilerHLSL hlsl(spv);
-	spirv_cross::CompilerHLSL::Options hlsl_options;
-	hlsl_options.shader_model = 50;
-	module.shaderResources = hlsl.get_shader_resources();
-	module.shaderOptions = hlsl.get_common_options();
-	module.shaderOptions.vulkan_semantics = true;
-	hlsl.set_hlsl_options(hlsl_options);
-	hlsl.set_common_options(module.shaderOptions);
-	module.hlslSource = hlsl.compile();
-
-	if (!module.hlslSource.empty())
-		module.hlslSource += "\n";
-
-	// MSL
-	spirv_cross::CompilerMSL msl(spv);
-	module.shaderResources = msl.get_shader_resources();
-	module.shaderOptions = msl.get_common_options();
-	module.shaderOptions.vulkan_semantics = true;
-	msl.set_common_options(module.shaderOptions);
-	module.mslSource = msl.compile();
-
-	if (!module.mslSource.empty())
-		module.mslSource += "\n";
+	module.binaryList = std::move(spv);
+
+	//validate alongside the parse unless this binary has been seen before
+	const uint64_t hash = HashBinary(module.binaryList);
+	auto cached = validationCache.find(hash);
+	std::future<std::shared_ptr<const validationResult_t>> pendingValidation;
+	if (cached != validationCache.end() && cached->second->wordCount == module.binaryList.size())
+	{
+		module.validation = cached->second;
+	}
+	else
+	{
+		pendingValidation = std::async(std::launch::async, ValidateBinary, std::cref(module.binaryList));
+	}
+
+	CompileTargets(module);
+
+	if (pendingValidation.valid())
+	{
+		module.validation = pendingValidation.get();
+		validationCache[hash] = module.validation;
+	}
+
+	//without GLSL there is nothing to recompile the shown SPIR-V from, so show the binary itself
+	if (!module.compileError.empty())
+	{
+		if (module.moduleType == shaderModule_t::moduleType_t::invalid)
+		{
+			module.moduleType = shaderModule_t::moduleType_t::unknown;
+		}
+		if (module.spirvSource.empty())
+		{
+			spvtools::SpirvTools tools(TargetEnvironment(module.binaryList));
+			tools.Disassemble(module.binaryList, &module.spirvSource, SPV_BINARY_TO_TEXT_OPTION_INDENT | SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES);
+		}
+	}
+}
+
+void shaderTool_t::CompileTargets(shaderModule_t& module)
+{
+	module.compileError.clear();
+	module.parsedIR.reset();
+	module.glslCompiler.reset();
+	module.hlslCompiler.reset();
+	module.mslCompiler.reset();
+	module.specConstants.clear();
+
+	//SPIRV-Cross throws on binaries it can't handle, which is exactly what invalid modules tend to be.
+	//parse once and hand a copy of the IR to each backend instead of letting every compiler parse again
+	try
+	{
+		spirv_cross::Parser parser(module.binaryList.data(), module.binaryList.size());
+		parser.parse();
+		module.parsedIR.reset(new spirv_cross::ParsedIR(std::move(parser.get_parsed_ir())));
+	}
+	catch (const std::exception& error)
+	{
+		RecordCompileError(module, "parse", error);
+		return;
+	}
+	const spirv_cross::ParsedIR& parsedIR = *module.parsedIR;
+
+	//each backend can give up on its own, the ones that didn't are kept
+	try
+	{
+		module.glslCompiler.reset(new spirv_cross::CompilerGLSL(parsedIR));
+		spirv_cross::CompilerGLSL& glsl = *module.glslCompiler;
+		module.shaderResources = glsl.get_shader_resources();
+		module.shaderOptions = glsl.get_common_options();
+		module.shaderOptions.vulkan_semantics = true;
+		glsl.set_common_options(module.shaderOptions);
+	}
+	catch (const std::exception& error)
+	{
+		module.glslCompiler.reset();
+		RecordCompileError(module, targetNames[GLSL_TYPE], error);
+	}
+
+	try
+	{
+		module.hlslCompiler.reset(new spirv_cross::CompilerHLSL(parsedIR));
+		ConfigureTarget(*module.hlslCompiler, HLSL_TYPE);
+	}
+	catch (const std::exception& error)
+	{
+		module.hlslCompiler.reset();
+		RecordCompileError(module, targetNames[HLSL_TYPE], error);
+	}
+
+	//spec constants and reflection are read through the GLSL compiler
+	if (module.glslCompiler)
+	{
+		try
+		{
+			CollectSpecConstants(module);
+			BuildReflectionModel(module);
+		}
+		catch (const std::exception& error)
+		{
+			module.specConstants.clear();
+			module.reflection = {};
+			RecordCompileError(module, "reflection", error);
+		}
+	}
+
+	EmitSource(module, GLSL_TYPE);
+	EmitSource(module, HLSL_TYPE);
+	EmitSource(module, MSL_TYPE);
+	if (module.glslCompiler && !module.glslSource.empty())
+	{
+		DetermineShaderModuleType(module, module.glslCompiler->get_execution_model());
+	}
+}
+
+void shaderTool_t::CollectSpecConstants(shaderModule_t& module)
+{
+	spirv_cross::CompilerGLSL& glsl = *module.glslCompiler;
+	module.specConstants.clear();
+
+	spirv_cross::SpecializationConstant workGroupSize[3] = {};
+	glsl.get_work_group_size_specialization_constants(workGroupSize[0], workGroupSize[1], workGroupSize[2]);
+
+	for (const spirv_cross::SpecializationConstant& specialization : glsl.get_specialization_constants())
+	{
+		const spirv_cross::SPIRConstant& constant = glsl.get_constant(specialization.id);
+		specConstant_t specConstant = {};
+		specConstant.id = specialization.id;
+		specConstant.constantID = specialization.constant_id;
+		specConstant.name = glsl.get_name(specialization.id);
+		specConstant.baseType = glsl.get_type(constant.constant_type).basetype;
+		specConstant.value = constant.m.c[0].r[0];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (workGroupSize[axis].id == specialization.id)
+			{
+				specConstant.workGroupAxis = axis;
+			}
+		}
+		module.specConstants.push_back(specConstant);
+	}
+}
+
+static const char* PrecisionName(spirv_cross::CompilerGLSL::Options::Precision precision)
+{
+	switch (precision)
+	{
+	case spirv_cross::CompilerGLSL::Options::Highp:
+		return "high";
+	case spirv_cross::CompilerGLSL::Options::Mediump:
+		return "medium";
+	case spirv_cross::CompilerGLSL::Options::Lowp:
+		return "low";
+	default:
+		return "N/A";
+	}
+}
+
+static const char* reflectionCategoryTitles[numResourceKinds] =
+{
+	"Atomics",
+	"Push constant buffers",
+	"Sampled images",
+	"Stage inputs",
+	"Stage outputs",
+	"Storage buffers",
+	"Storage images",
+	"Sub pass inputs",
+	"Uniform buffers",
+	"Separate images",
+	"Separate samplers",
+	"Acceleration structures",
+};
+
+static std::string BindingText(const reflectedResource_t& resource)
+{
+	if (resource.location != reflectionIndex_t::unassigned)
+	{
+		return "location " + std::to_string(resource.location);
+	}
+
+	std::string text;
+	if (resource.set != reflectionIndex_t::unassigned)
+	{
+		text = "set " + std::to_string(resource.set);
+	}
+	if (resource.binding != reflectionIndex_t::unassigned)
+	{
+		text += (text.empty() ? "binding " : ", binding ") + std::to_string(resource.binding);
+	}
+	return text;
+}
+
+void shaderTool_t::BuildReflectionModel(shaderModule_t& module)
+{
+	reflectionModel_t& reflection = module.reflection;
+	reflection = {};
+
+	reflection.summary.push_back("GLSL Version: " + std::to_string(module.shaderOptions.version));
+	reflection.summary.push_back(std::string("Uses OpenGL ES: ") + (module.shaderOptions.es ? "true" : "false"));
+	reflection.summary.push_back(std::string("Floating point precision: ") + PrecisionName(module.shaderOptions.fragment.default_float_precision));
+	reflection.summary.push_back(std::string("integer precision: ") + PrecisionName(module.shaderOptions.fragment.default_int_precision));
+
+	module.reflectionIndex.Build(*module.glslCompiler, module.shaderResources);
+	const std::vector<reflectedResource_t>& resources = module.reflectionIndex.resources;
+	reflection.rows.reserve(resources.size());
+
+	//the index stores resources grouped by kind, in kind order
+	unsigned int resourceIter = 0;
+	for (unsigned int kindIter = 0; kindIter < numResourceKinds; kindIter++)
+	{
+		reflectionCategory_t category = {};
+		category.firstRow = (unsigned int)reflection.rows.size();
+		for (; resourceIter < resources.size() && resources[resourceIter].kind == kindIter; resourceIter++)
+		{
+			const reflectedResource_t& resource = resources[resourceIter];
+			reflectionRow_t row = {};
+			row.columns[reflectionRow_t::index] = std::to_string(resourceIter - category.firstRow);
+			row.columns[reflectionRow_t::id] = std::to_string(resource.id);
+			row.columns[reflectionRow_t::name] = resource.name;
+			row.columns[reflectionRow_t::type] = resource.typeName;
+			row.columns[reflectionRow_t::binding] = BindingText(resource);
+			row.resource = resourceIter;
+			reflection.rows.push_back(std::move(row));
+		}
+		category.rowCount = (unsigned int)reflection.rows.size() - category.firstRow;
+		category.title = std::string(reflectionCategoryTitles[kindIter]) + " (" + std::to_string(category.rowCount) + ")##" + reflectionCategoryTitles[kindIter];
+		reflection.categories.push_back(std::move(category));
+	}
+}
+
+void shaderTool_t::ApplySpecConstant(shaderModule_t& module, const specConstant_t& constant)
+{
+	//the same ID refers to the same constant in every compiler since they share one parsed IR.
+	//the MSL compiler picks the value up when it is recreated
+	module.glslCompiler->get_constant(constant.id).m.c[0].r[0] = constant.value;
+	if (module.hlslCompiler)
+	{
+		module.hlslCompiler->get_constant(constant.id).m.c[0].r[0] = constant.value;
+	}
+
+	for (unsigned int typeIter = 0; typeIter < UNKNOWN_TYPE; typeIter++)
+	{
+		module.staleSources[typeIter] = true;
+	}
+}
+
+//HLSL and MSL compilers derive from the GLSL one, so every target can be driven through the base
+static spirv_cross::CompilerGLSL* TargetCompiler(shaderModule_t& module, ShaderType type)
+{
+	switch (type)
+	{
+	case GLSL_TYPE:
+		return module.glslCompiler.get();
+	case HLSL_TYPE:
+		return module.hlslCompiler.get();
+	case MSL_TYPE:
+		return module.mslCompiler.get();
+	default:
+		return nullptr;
+	}
+}
+
+static std::string* TargetSource(shaderModule_t& module, ShaderType type)
+{
+	switch (type)
+	{
+	case GLSL_TYPE:
+		return &module.glslSource;
+	case HLSL_TYPE:
+		return &module.hlslSource;
+	case MSL_TYPE:
+		return &module.mslSource;
+	default:
+		return nullptr;
+	}
+}
+
+void shaderTool_t::ResetMSLCompiler(shaderModule_t& module)
+{
+	if (!module.parsedIR)
+	{
+		return;
+	}
+
+	//copying the cached IR is much cheaper than parsing again
+	try
+	{
+		module.mslCompiler.reset(new spirv_cross::CompilerMSL(*module.parsedIR));
+		spirv_cross::CompilerMSL& msl = *module.mslCompiler;
+		ConfigureTarget(msl, MSL_TYPE);
+
+		for (const specConstant_t& constant : module.specConstants)
+		{
+			msl.get_constant(constant.id).m.c[0].r[0] = constant.value;
+		}
+	}
+	catch (const std::exception& error)
+	{
+		module.mslCompiler.reset();
+		RecordCompileError(module, targetNames[MSL_TYPE], error);
+	}
+}
+
+void shaderTool_t::EmitSource(shaderModule_t& module, ShaderType type)
+{
+	if (type == MSL_TYPE)
+	{
+		ResetMSLCompiler(module);
+	}
+
+	spirv_cross::CompilerGLSL* compiler = TargetCompiler(module, type);
+	std::string* source = TargetSource(module, type);
+	if (compiler == nullptr || source == nullptr)
+	{
+		return;
+	}
+
+	//append the compiler's blocks directly instead of copying a concatenated string around
+	source->clear();
+	//a spec constant value can make a target give up, the other targets and the module stay usable
+	try
+	{
+		compiler->compile([source](const char* data, size_t size) { source->append(data, size); });
+	}
+	catch (const std::exception& error)
+	{
+		source->clear();
+		RecordCompileError(module, targetNames[type], error);
+	}
+	if (!source->empty())
+		*source += "\n";
+	module.staleSources[type] = false;
+}
+
+void shaderTool_t::ExportSources(std::string fileName)
+{
+	if (fileName.length() <= 0 || shaderModules.empty())
+	{
+		return;
+	}
+
+	static const char* extensions[UNKNOWN_TYPE] = { ".hlsl", ".glsl", ".metal" };
+	shaderModule_t& module = shaderModules[currentModule];
+	for (unsigned int typeIter = 0; typeIter < UNKNOWN_TYPE; typeIter++)
+	{
+		if (typeIter == MSL_TYPE)
+		{
+			ResetMSLCompiler(module);
+		}
+
+		spirv_cross::CompilerGLSL* compiler = TargetCompiler(module, (ShaderType)typeIter);
+		if (compiler == nullptr)
+		{
+			continue;
+		}
+
+		//stream straight to disk so only one block of the output is held at a time
+		std::ofstream file(fileName + extensions[typeIter], std::ios::binary);
+		if (!file)
+		{
+			fprintf(stderr, "Failed to open export file: %s%s\n", fileName.c_str(), extensions[typeIter]);
+			continue;
+		}
+		try
+		{
+			compiler->compile([&file](const char* data, size_t size) { file.write(data, (std::streamsize)size); });
+			file << "\n";
+		}
+		catch (const std::exception& error)
+		{
+			//what was streamed before the throw is left in the file, so the error is appended to say it is cut short
+			file << "\n// SPIRV-Cross: " << error.what() << "\n";
+			RecordCompileError(module, targetNames[typeIter], error);
+		}
+	}
+}
+
+//counts the instructions in each module dump the pass manager prints before every pass without keeping the text
+class passDumpCounter_t : public std::streambuf
+{
+public:
+	std::vector<int> instructions; //one entry per dump, the last one is printed after the final pass
+
+protected:
+	int_type overflow(int_type character) override
+	{
+		if (!traits_type::eq_int_type(character, traits_type::eof()))
+		{
+			Put(traits_type::to_char_type(character));
+		}
+		return traits_type::not_eof(character);
+	}
+
+	std::streamsize xsputn(const char* data, std::streamsize size) override
+	{
+		for (std::streamsize charIter = 0; charIter < size; charIter++)
+		{
+			Put(data[charIter]);
+		}
+		return size;
+	}
+
+private:
+	std::string line; //only the start of a line matters
+
+	void Put(char character)
+	{
+		if (character != '\n')
+		{
+			if (line.size() < 16)
+			{
+				line += character;
+			}
+			return;
+		}
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if (line.compare(0, 5, "; IR ") == 0)
+		{
+			instructions.push_back(0);
+		}
+		else if (first != std::string::npos && line[first] != ';' && !instructions.empty())
+		{
+			instructions.back()++;
+		}
+		line.clear();
+	}
+};
+
+//the time report prints "Failed" for anything it couldn't measure
+static double ReportValue(const std::string& text)
+{
+	char* end = nullptr;
+	double value = strtod(text.c_str(), &end);
+	return end == text.c_str() ? -1.0 : value;
+}
+
+//the report has a header row and then one row per pass in run order:
+//name, CPU, wall, user and system seconds, then the RSS delta in KB and the page fault delta
+static void ParseTimeReport(const std::string& report, std::vector<passReport_t>& passes)
+{
+	std::istringstream stream(report);
+	size_t passIter = 0;
+	for (std::string line; passIter < passes.size() && std::getline(stream, line);)
+	{
+		std::istringstream row(line);
+		std::string name, cpu, wall, user, system, rss;
+		if (!(row >> name >> cpu >> wall >> user >> system >> rss) || name == "PASS")
+		{
+			continue;
+		}
+
+		passReport_t& pass = passes[passIter++];
+		pass.cpuTime = ReportValue(cpu);
+		pass.wallTime = ReportValue(wall);
+		pass.rssDelta = (long)ReportValue(rss);
+	}
+}
+
+//runs on a worker thread with its own copy of the binary, so it must not touch the tool or any module
+static std::shared_ptr<const optimizedModule_t> OptimizeBinary(std::vector<uint32_t> binary, int recipe, std::string customPasses, bool countInstructions)
+{
+	std::shared_ptr<optimizedModule_t> result = std::make_shared<optimizedModule_t>();
+	const spv_target_env environment = TargetEnvironment(binary);
+	spvtools::Optimizer optimizer(environment);
+	optimizer.SetMessageConsumer([&result](spv_message_level_t, const char*, const spv_position_t&, const char* message)
+	{
+		result->messages += message;
+		result->messages += "\n";
+	});
+
+	switch (recipe)
+	{
+	case optimizedModule_t::performance:
+		optimizer.RegisterPerformancePasses();
+		break;
+	case optimizedModule_t::size:
+		optimizer.RegisterSizePasses();
+		break;
+	case optimizedModule_t::legalization:
+		optimizer.RegisterLegalizationPasses();
+		break;
+	default:
+	{
+		std::vector<std::string> flags;
+		std::istringstream stream(customPasses);
+		for (std::string flag; stream >> flag;)
+		{
+			flags.push_back(flag);
+		}
+		if (!optimizer.RegisterPassesFromFlags(flags))
+		{
+			return result;
+		}
+		break;
+	}
+	}
+
+	for (const char* name : optimizer.GetPassNames())
+	{
+		passReport_t pass = {};
+		pass.name = name;
+		result->passes.push_back(pass);
+	}
+
+	//the pass timers don't include the dumps, so counting instructions doesn't skew the timings
+	std::ostringstream timeReport;
+	passDumpCounter_t dumpCounter;
+	std::ostream dumpStream(&dumpCounter);
+	optimizer.SetTimeReport(&timeReport);
+	if (countInstructions)
+	{
+		optimizer.SetPrintAll(&dumpStream);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	result->succeeded = optimizer.Run(binary.data(), binary.size(), &result->binary);
+	result->wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	ParseTimeReport(timeReport.str(), result->passes);
+	const std::vector<int>& dumps = dumpCounter.instructions;
+	for (size_t passIter = 0; passIter < result->passes.size() && passIter + 1 < dumps.size(); passIter++)
+	{
+		result->passes[passIter].instructionsBefore = dumps[passIter];
+		result->passes[passIter].instructionsAfter = dumps[passIter + 1];
+	}
+
+	if (!result->succeeded)
+	{
+		return result;
+	}
+
+	spvtools::SpirvTools tools(environment);
+	tools.Disassemble(result->binary, &result->spirvSource, SPV_BINARY_TO_TEXT_OPTION_INDENT | SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES);
+
+	//a backend failing to handle the optimized module shouldn't hide the ones that did
+	spirv_cross::Parser parser(result->binary.data(), result->binary.size());
+	try
+	{
+		parser.parse();
+	}
+	catch (const std::exception& error)
+	{
+		result->messages += std::string("SPIRV-Cross: ") + error.what() + "\n";
+		return result;
+	}
+
+	for (unsigned int typeIter = 0; typeIter < UNKNOWN_TYPE; typeIter++)
+	{
+		try
+		{
+			std::unique_ptr<spirv_cross::CompilerGLSL> compiler;
+			switch (typeIter)
+			{
+			case GLSL_TYPE:
+				compiler.reset(new spirv_cross::CompilerGLSL(parser.get_parsed_ir()));
+				break;
+			case HLSL_TYPE:
+				compiler.reset(new spirv_cross::CompilerHLSL(parser.get_parsed_ir()));
+				break;
+			default:
+				compiler.reset(new spirv_cross::CompilerMSL(parser.get_parsed_ir()));
+				break;
+			}
+			ConfigureTarget(*compiler, (ShaderType)typeIter);
+			result->sources[typeIter] = compiler->compile();
+		}
+		catch (const std::exception& error)
+		{
+			result->messages += std::string("SPIRV-Cross: ") + error.what() + "\n";
+		}
+	}
+	return result;
+}
+
+void shaderTool_t::StartOptimization()
+{
+	if (shaderModules.empty() || pendingOptimization.valid())
+	{
+		return;
+	}
+
+	pendingOptimizationModule = currentModule;
+	pendingOptimizationLoad = loadCount;
+	pendingOptimization = std::async(std::launch::async, OptimizeBinary, shaderModules[currentModule].binaryList, optimizerRecipe, std::string(customPasses), countInstructions);
+}
+
+void shaderTool_t::PollOptimization()
+{
+	if (!pendingOptimization.valid() || pendingOptimization.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return;
+	}
+
+	std::shared_ptr<const optimizedModule_t> optimized = pendingOptimization.get();
+	//drop the result if another file was loaded while the optimizer ran
+	if (pendingOptimizationLoad == loadCount && pendingOptimizationModule < shaderModules.size())
+	{
+		shaderModules[pendingOptimizationModule].optimized = std::move(optimized);
+	}
 }
 
 void shaderTool_t::Load(std::string fileName)
 {
 	shaderModules.clear();
+	currentModule = 0;
+	layoutResource = -1;
+	loadCount++;
 	if (fileName.length() <= 0)
 	{
 		return; //if filename is empty, return. dont bother loading that
@@ -702,7 +1672,7 @@ void shaderTool_t::Load(std::string fileName)
 		std::vector<uint32_t> spv_result(std::move(ReadSPIRVFile(fileName.c_str())));
 
 		CompileAll(spv_result, module);
-		shaderModules.push_back(module);
+		shaderModules.push_back(std::move(module));
 	}
 	else if (IsAsciiSPIRVFile(fileName.c_str()))
 	{
@@ -863,34 +1833,32 @@ bool shaderTool_t::IsAsciiSPIRVFile(const char* fileName)
 	if (file == nullptr)
 		return false;
 
-	char buff[1024];
+	char buff[1024] = {};
 	fgets(buff, 1024, file);
-	if (strcmp(buff, "; SPIR-V\n") == 0)
-	{
-		fclose(file);
-		return true;
-	}
-
-	return false;
+	fclose(file);
+	return strcmp(buff, "; SPIR-V\n") == 0;
 }
 
 void shaderTool_t::ReadFromAsciiSPIRVFile(const char* fileName)
 {
 	FILE* file = nullptr;
-	fopen_s(&file, fileName, "r+");
+	fopen_s(&file, fileName, "rb");
 	if (file == nullptr)
 		return;
 
-	char buff[1024];
 	shaderModule_t module = {};
 	module.moduleType = shaderModule_t::moduleType_t::unknown;
 
-	while (!feof(file))
+	//the assembler wants the whole text in one string, so read it in one go instead of a line at a time
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	rewind(file);
+	if (length > 0)
 	{
-		fgets(buff, 1024, file);
-		module.spirvSource += buff;
+		module.spirvSource.resize((size_t)length);
+		module.spirvSource.resize(fread(&module.spirvSource[0], 1, (size_t)length, file));
 	}
 
-	shaderModules.push_back(module);
+	shaderModules.push_back(std::move(module));
 	fclose(file);
 }
\ No newline at end of file
@@ -0,0 +1,559 @@
+/*
+ Copyright (c) 2021 UAA Software
+
+ Permission is hereby granted, free of charge, to any person obtaining
+ a copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//headless benchmark: runs a corpus of SPIR-V modules through parsing, reflection, every
+//SPIRV-Cross backend and the SPIRV-Tools disassembler, then reports throughput and latency as JSON.
+//with --baseline it compares against an earlier run and fails on slowdowns beyond --threshold.
+
+#include <cross/spirv_glsl.hpp>
+#include <cross/spirv_hlsl.hpp>
+#include <cross/spirv_msl.hpp>
+#include <cross/spirv_parser.hpp>
+#include <spirv-tools/libspirv.hpp>
+#include <json/json.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(WIN32)
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+struct corpusModule_t
+{
+	string									name = {};
+	vector<uint32_t>						binary = {};
+	unique_ptr<spirv_cross::ParsedIR>		parsedIR; //parsed once up front so backend stages only time emission
+};
+
+struct stageResult_t
+{
+	string									name = {};
+	vector<double>							latencies = {}; //seconds, one per module per iteration
+	double									totalSeconds = 0.0;
+	size_t									totalBytes = 0;
+	size_t									failures = 0;
+	size_t									peakRSS = 0; //kilobytes, sampled after the stage finished
+};
+
+//returns false if the stage failed for this module. only the work inside the timer is measured
+typedef function<bool(corpusModule_t& module, double& seconds)> stageFunc_t;
+
+struct stage_t
+{
+	const char*								name;
+	stageFunc_t								run;
+};
+
+// -------------------------------------------------------- Helpers -----------------------------------------------
+
+static double Now()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static size_t PeakRSSKilobytes()
+{
+#if defined(WIN32)
+	PROCESS_MEMORY_COUNTERS counters = {};
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage = {};
+	getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+	return (size_t)usage.ru_maxrss / 1024;
+#else
+	return (size_t)usage.ru_maxrss;
+#endif
+#endif
+}
+
+static double Percentile(vector<double> samples, double fraction)
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+	sort(samples.begin(), samples.end());
+	size_t index = (size_t)(fraction * (double)(samples.size() - 1) + 0.5);
+	return samples[min(index, samples.size() - 1)];
+}
+
+static vector<uint32_t> ReadSPIRVFile(const string& fileName)
+{
+	ifstream file(fileName, ios::binary | ios::ate);
+	if (!file)
+	{
+		return {};
+	}
+	size_t size = (size_t)file.tellg();
+	vector<uint32_t> spirv(size / sizeof(uint32_t));
+	file.seekg(0);
+	if (!file.read((char*)spirv.data(), spirv.size() * sizeof(uint32_t)))
+	{
+		spirv.clear();
+	}
+	return spirv;
+}
+
+//a compute shader with a uniform block of blockMembers vec4s and a chain of functionCount functions,
+//each doing opsPerFunction vector ops. big enough settings stress every stage without needing files on disk
+static string GenerateAssembly(unsigned int blockMembers, unsigned int functionCount, unsigned int opsPerFunction)
+{
+	stringstream text;
+	text << "OpCapability Shader\n"
+		"OpMemoryModel Logical GLSL450\n"
+		"OpEntryPoint GLCompute %main \"main\"\n"
+		"OpExecutionMode %main LocalSize 1 1 1\n"
+		"OpName %main \"main\"\n"
+		"OpName %Block \"Block\"\n"
+		"OpName %Output \"Output\"\n";
+	for (unsigned int memberIter = 0; memberIter < blockMembers; memberIter++)
+	{
+		text << "OpMemberName %Block " << memberIter << " \"m" << memberIter << "\"\n";
+	}
+	for (unsigned int functionIter = 0; functionIter < functionCount; functionIter++)
+	{
+		text << "OpName %f" << functionIter << " \"f" << functionIter << "\"\n";
+	}
+	text << "OpDecorate %Block Block\n"
+		"OpDecorate %block DescriptorSet 0\n"
+		"OpDecorate %block Binding 0\n"
+		"OpDecorate %runtime ArrayStride 16\n"
+		"OpMemberDecorate %Output 0 Offset 0\n"
+		"OpDecorate %Output BufferBlock\n"
+		"OpDecorate %output DescriptorSet 0\n"
+		"OpDecorate %output Binding 1\n";
+	for (unsigned int memberIter = 0; memberIter < blockMembers; memberIter++)
+	{
+		text << "OpMemberDecorate %Block " << memberIter << " Offset " << memberIter * 16 << "\n";
+	}
+	text << "%void = OpTypeVoid\n"
+		"%voidFn = OpTypeFunction %void\n"
+		"%float = OpTypeFloat 32\n"
+		"%vec4 = OpTypeVector %float 4\n"
+		"%int = OpTypeInt 32 1\n"
+		"%vec4Fn = OpTypeFunction %vec4 %vec4\n"
+		"%Block = OpTypeStruct";
+	for (unsigned int memberIter = 0; memberIter < blockMembers; memberIter++)
+	{
+		text << " %vec4";
+	}
+	text << "\n%blockPtr = OpTypePointer Uniform %Block\n"
+		"%block = OpVariable %blockPtr Uniform\n"
+		"%runtime = OpTypeRuntimeArray %vec4\n"
+		"%Output = OpTypeStruct %runtime\n"
+		"%outputPtr = OpTypePointer Uniform %Output\n"
+		"%output = OpVariable %outputPtr Uniform\n"
+		"%vec4Ptr = OpTypePointer Uniform %vec4\n";
+	for (unsigned int memberIter = 0; memberIter < blockMembers; memberIter++)
+	{
+		text << "%c" << memberIter << " = OpConstant %int " << memberIter << "\n";
+	}
+
+	for (unsigned int functionIter = 0; functionIter < functionCount; functionIter++)
+	{
+		unsigned int member = functionIter % blockMembers;
+		text << "%f" << functionIter << " = OpFunction %vec4 None %vec4Fn\n"
+			"%f" << functionIter << "_x = OpFunctionParameter %vec4\n"
+			"%f" << functionIter << "_entry = OpLabel\n"
+			"%f" << functionIter << "_ptr = OpAccessChain %vec4Ptr %block %c" << member << "\n"
+			"%f" << functionIter << "_v0 = OpLoad %vec4 %f" << functionIter << "_ptr\n";
+		string previous = "%f" + to_string(functionIter) + "_x";
+		for (unsigned int opIter = 0; opIter < opsPerFunction; opIter++)
+		{
+			string result = "%f" + to_string(functionIter) + "_r" + to_string(opIter);
+			text << result << ((opIter & 1) ? " = OpFMul %vec4 " : " = OpFAdd %vec4 ") << previous << " %f" << functionIter << "_v0\n";
+			previous = result;
+		}
+		text << "OpReturnValue " << previous << "\n"
+			"OpFunctionEnd\n";
+	}
+
+	text << "%main = OpFunction %void None %voidFn\n"
+		"%main_entry = OpLabel\n"
+		"%main_ptr = OpAccessChain %vec4Ptr %block %c0\n"
+		"%main_v = OpLoad %vec4 %main_ptr\n";
+	string previous = "%main_v";
+	for (unsigned int functionIter = 0; functionIter < functionCount; functionIter++)
+	{
+		string result = "%call" + to_string(functionIter);
+		text << result << " = OpFunctionCall %vec4 %f" << functionIter << " " << previous << "\n";
+		previous = result;
+	}
+	text << "%main_out = OpAccessChain %vec4Ptr %output %c0 %c0\n"
+		"OpStore %main_out " << previous << "\n"
+		"OpReturn\n"
+		"OpFunctionEnd\n";
+	return text.str();
+}
+
+static void PrintUsage()
+{
+	printf("usage: SPIRV_Benchmark [options] [file.spv | directory]...\n"
+		"  --iterations N     runs of every stage over every module (default 5)\n"
+		"  --no-generated     skip the generated giant modules\n"
+		"  --scale N          size multiplier for the generated modules (default 1)\n"
+		"  --output FILE      write results as JSON (default: stdout)\n"
+		"  --baseline FILE    compare against an earlier --output and fail on regressions\n"
+		"  --threshold F      allowed slowdown against the baseline, 0.1 = 10%% (default 0.1)\n");
+}
+
+// -------------------------------------------------------- Stages -----------------------------------------------
+
+template <typename CompilerType>
+static bool CompileStage(corpusModule_t& module, double& seconds, const function<void(CompilerType&)>& setup)
+{
+	//a fresh compiler every time: CompilerMSL rewrites its IR while compiling
+	CompilerType compiler(*module.parsedIR);
+	spirv_cross::CompilerGLSL::Options options = compiler.get_common_options();
+	options.vulkan_semantics = true;
+	compiler.set_common_options(options);
+	if (setup)
+	{
+		setup(compiler);
+	}
+
+	double start = Now();
+	string source = compiler.compile();
+	seconds = Now() - start;
+	return !source.empty();
+}
+
+static vector<stage_t> BuildStages(spvtools::SpirvTools& tools)
+{
+	vector<stage_t> stages;
+	stages.push_back({ "parse", [](corpusModule_t& module, double& seconds)
+	{
+		double start = Now();
+		spirv_cross::Parser parser(module.binary.data(), module.binary.size());
+		parser.parse();
+		seconds = Now() - start;
+		return true;
+	} });
+
+	stages.push_back({ "reflect", [](corpusModule_t& module, double& seconds)
+	{
+		spirv_cross::CompilerGLSL compiler(*module.parsedIR);
+		double start = Now();
+		spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+		seconds = Now() - start;
+		return true;
+	} });
+
+	stages.push_back({ "glsl", [](corpusModule_t& module, double& seconds)
+	{
+		return CompileStage<spirv_cross::CompilerGLSL>(module, seconds, nullptr);
+	} });
+
+	stages.push_back({ "hlsl", [](corpusModule_t& module, double& seconds)
+	{
+		return CompileStage<spirv_cross::CompilerHLSL>(module, seconds, [](spirv_cross::CompilerHLSL& compiler)
+		{
+			spirv_cross::CompilerHLSL::Options options;
+			options.shader_model = 50;
+			compiler.set_hlsl_options(options);
+		});
+	} });
+
+	stages.push_back({ "msl", [](corpusModule_t& module, double& seconds)
+	{
+		return CompileStage<spirv_cross::CompilerMSL>(module, seconds, nullptr);
+	} });
+
+	spvtools::SpirvTools* toolsPtr = &tools;
+	stages.push_back({ "disassemble", [toolsPtr](corpusModule_t& module, double& seconds)
+	{
+		string text;
+		double start = Now();
+		bool result = toolsPtr->Disassemble(module.binary, &text, SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES | SPV_BINARY_TO_TEXT_OPTION_INDENT | SPV_BINARY_TO_TEXT_OPTION_PARALLEL);
+		seconds = Now() - start;
+		return result;
+	} });
+	return stages;
+}
+
+// -------------------------------------------------------- Reporting -----------------------------------------------
+
+static Json::Value StageToJson(const stageResult_t& result, size_t corpusSize)
+{
+	double megabytes = (double)result.totalBytes / (1024.0 * 1024.0);
+	size_t runs = result.latencies.size();
+	Json::Value stage(Json::objectValue);
+	stage["runs"] = (Json::UInt64)runs;
+	stage["failures"] = (Json::UInt64)result.failures;
+	stage["total_ms"] = result.totalSeconds * 1000.0;
+	stage["mb_per_s"] = result.totalSeconds > 0.0 ? megabytes / result.totalSeconds : 0.0;
+	stage["modules_per_s"] = result.totalSeconds > 0.0 ? (double)runs / result.totalSeconds : 0.0;
+	stage["p50_ms"] = Percentile(result.latencies, 0.50) * 1000.0;
+	stage["p99_ms"] = Percentile(result.latencies, 0.99) * 1000.0;
+	stage["peak_rss_kb"] = (Json::UInt64)result.peakRSS;
+	stage["corpus_modules"] = (Json::UInt64)corpusSize;
+	return stage;
+}
+
+//a stage regresses if its throughput dropped or its median latency grew by more than threshold.
+//a stage the baseline has but this run lacks counts as a regression, a stage the baseline lacks is only reported
+static int CompareWithBaseline(const Json::Value& current, const Json::Value& baseline, double threshold)
+{
+	int regressions = 0;
+	const Json::Value& baselineStages = baseline["stages"];
+	const Json::Value& currentStages = current["stages"];
+	for (const string& stageName : currentStages.getMemberNames())
+	{
+		if (!baselineStages.isMember(stageName))
+		{
+			fprintf(stderr, "%-12s not in the baseline, not compared\n", stageName.c_str());
+		}
+	}
+	for (const string& stageName : baselineStages.getMemberNames())
+	{
+		const Json::Value& before = baselineStages[stageName];
+		if (!currentStages.isMember(stageName))
+		{
+			fprintf(stderr, "%-12s in the baseline but not run  REGRESSION\n", stageName.c_str());
+			regressions++;
+			continue;
+		}
+		const Json::Value& after = currentStages[stageName];
+
+		double throughputBefore = before["mb_per_s"].asDouble();
+		double throughputAfter = after["mb_per_s"].asDouble();
+		double medianBefore = before["p50_ms"].asDouble();
+		double medianAfter = after["p50_ms"].asDouble();
+		bool slower = (throughputBefore > 0.0 && throughputAfter < throughputBefore * (1.0 - threshold)) ||
+			(medianBefore > 0.0 && medianAfter > medianBefore * (1.0 + threshold));
+		fprintf(stderr, "%-12s %10.2f -> %10.2f MB/s, p50 %8.3f -> %8.3f ms%s\n", stageName.c_str(),
+			throughputBefore, throughputAfter, medianBefore, medianAfter, slower ? "  REGRESSION" : "");
+		if (slower)
+		{
+			regressions++;
+		}
+	}
+	return regressions;
+}
+
+int main(int numArgs, char* arguments[])
+{
+	unsigned int iterations = 5;
+	unsigned int scale = 1;
+	bool generate = true;
+	double threshold = 0.1;
+	string outputPath;
+	string baselinePath;
+	vector<string> inputs;
+
+	for (int argIter = 1; argIter < numArgs; argIter++)
+	{
+		string argument = arguments[argIter];
+		bool hasValue = argIter + 1 < numArgs;
+		if (argument == "--iterations" && hasValue)
+			iterations = max(1, atoi(arguments[++argIter]));
+		else if (argument == "--scale" && hasValue)
+			scale = max(1, atoi(arguments[++argIter]));
+		else if (argument == "--no-generated")
+			generate = false;
+		else if (argument == "--output" && hasValue)
+			outputPath = arguments[++argIter];
+		else if (argument == "--baseline" && hasValue)
+			baselinePath = arguments[++argIter];
+		else if (argument == "--threshold" && hasValue)
+			threshold = atof(arguments[++argIter]);
+		else if (argument == "--help" || argument == "-h")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else
+			inputs.push_back(argument);
+	}
+
+	// ------------------------------------------- Corpus ----------------------------------------
+	vector<corpusModule_t> corpus;
+	for (const string& input : inputs)
+	{
+		vector<string> files;
+		if (filesystem::is_directory(input))
+		{
+			for (const filesystem::directory_entry& entry : filesystem::recursive_directory_iterator(input))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".spv")
+				{
+					files.push_back(entry.path().string());
+				}
+			}
+			sort(files.begin(), files.end());
+		}
+		else
+		{
+			files.push_back(input);
+		}
+
+		for (const string& file : files)
+		{
+			corpusModule_t module = {};
+			module.name = file;
+			module.binary = ReadSPIRVFile(file);
+			if (module.binary.empty())
+			{
+				fprintf(stderr, "Failed to read SPIR-V file: %s\n", file.c_str());
+				continue;
+			}
+			corpus.push_back(std::move(module));
+		}
+	}
+
+	spvtools::SpirvTools tools(SPV_ENV_UNIVERSAL_1_5);
+	if (generate)
+	{
+		struct generated_t { const char* name; unsigned int blockMembers, functions, ops; };
+		const generated_t generated[] =
+		{
+			{ "generated:wide_block", 4096 * scale, 16, 4 },
+			{ "generated:many_functions", 64, 2048 * scale, 16 },
+		};
+		for (const generated_t& settings : generated)
+		{
+			corpusModule_t module = {};
+			module.name = settings.name;
+			if (!tools.Assemble(GenerateAssembly(settings.blockMembers, settings.functions, settings.ops), &module.binary))
+			{
+				fprintf(stderr, "Failed to assemble %s\n", settings.name);
+				continue;
+			}
+			corpus.push_back(std::move(module));
+		}
+	}
+
+	if (corpus.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	size_t corpusBytes = 0;
+	for (corpusModule_t& module : corpus)
+	{
+		corpusBytes += module.binary.size() * sizeof(uint32_t);
+		spirv_cross::Parser parser(module.binary.data(), module.binary.size());
+		parser.parse();
+		module.parsedIR.reset(new spirv_cross::ParsedIR(std::move(parser.get_parsed_ir())));
+	}
+
+	// ------------------------------------------- Run ----------------------------------------
+	vector<stage_t> stages = BuildStages(tools);
+	vector<stageResult_t> results;
+	for (const stage_t& stage : stages)
+	{
+		stageResult_t result = {};
+		result.name = stage.name;
+		for (unsigned int iteration = 0; iteration < iterations; iteration++)
+		{
+			for (corpusModule_t& module : corpus)
+			{
+				double seconds = 0.0;
+				bool succeeded = false;
+				try
+				{
+					succeeded = stage.run(module, seconds);
+				}
+				catch (const std::exception& error)
+				{
+					if (iteration == 0)
+					{
+						fprintf(stderr, "%s failed on %s: %s\n", stage.name, module.name.c_str(), error.what());
+					}
+				}
+
+				if (!succeeded)
+				{
+					result.failures++;
+					continue;
+				}
+				result.latencies.push_back(seconds);
+				result.totalSeconds += seconds;
+				result.totalBytes += module.binary.size() * sizeof(uint32_t);
+			}
+		}
+		result.peakRSS = PeakRSSKilobytes();
+		results.push_back(std::move(result));
+	}
+
+	// ------------------------------------------- Report ----------------------------------------
+	Json::Value report(Json::objectValue);
+	report["iterations"] = iterations;
+	report["corpus"]["modules"] = (Json::UInt64)corpus.size();
+	report["corpus"]["bytes"] = (Json::UInt64)corpusBytes;
+	report["peak_rss_kb"] = (Json::UInt64)PeakRSSKilobytes();
+	report["stages"] = Json::Value(Json::objectValue);
+	for (const stageResult_t& result : results)
+	{
+		report["stages"][result.name] = StageToJson(result, corpus.size());
+	}
+
+	Json::StreamWriterBuilder builder;
+	builder["indentation"] = "\t";
+	string json = Json::writeString(builder, report);
+	if (outputPath.empty())
+	{
+		cout << json << endl;
+	}
+	else
+	{
+		ofstream output(outputPath);
+		output << json << "\n";
+	}
+
+	if (!baselinePath.empty())
+	{
+		ifstream baselineFile(baselinePath);
+		Json::Value baseline;
+		Json::CharReaderBuilder readerBuilder;
+		string errors;
+		if (!baselineFile || !Json::parseFromStream(readerBuilder, baselineFile, &baseline, &errors))
+		{
+			fprintf(stderr, "Failed to read baseline %s %s\n", baselinePath.c_str(), errors.c_str());
+			return 1;
+		}
+		if (CompareWithBaseline(report, baseline, threshold) > 0)
+		{
+			return 2;
+		}
+	}
+	return 0;
+}
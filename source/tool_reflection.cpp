@@ -0,0 +1,334 @@
+/*
+ Copyright (c) 2021 UAA Software
+ 
+ Permission is hereby granted, free of charge, to any person obtaining
+ a copy of this software and associated documentation files (the
+ "Software"), to deal in the Software without restriction, including
+ without limitation the rights to use, copy, modify, merge, publish,
+ distribute, sublicense, and/or sell copies of the Software, and to
+ permit persons to whom the Software is furnished to do so, subject to
+ the following conditions:
+ 
+ The above copyright notice and this permission notice shall be
+ included in all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "tool_reflection.h"
+
+using namespace std;
+
+static const char* resourceKindNames[numResourceKinds] =
+{
+	"atomic_counters",
+	"push_constant_buffers",
+	"sampled_images",
+	"stage_inputs",
+	"stage_outputs",
+	"storage_buffers",
+	"storage_images",
+	"subpass_inputs",
+	"uniform_buffers",
+	"separate_images",
+	"separate_samplers",
+	"acceleration_structures",
+};
+
+// -------------------------------------------------------- Helpers -----------------------------------------------
+
+static string ScalarName(spirv_cross::SPIRType::BaseType baseType)
+{
+	switch (baseType)
+	{
+	case spirv_cross::SPIRType::Boolean: return "bool";
+	case spirv_cross::SPIRType::SByte: return "int8";
+	case spirv_cross::SPIRType::UByte: return "uint8";
+	case spirv_cross::SPIRType::Short: return "int16";
+	case spirv_cross::SPIRType::UShort: return "uint16";
+	case spirv_cross::SPIRType::Int: return "int";
+	case spirv_cross::SPIRType::UInt: return "uint";
+	case spirv_cross::SPIRType::Int64: return "int64";
+	case spirv_cross::SPIRType::UInt64: return "uint64";
+	case spirv_cross::SPIRType::AtomicCounter: return "atomic_uint";
+	case spirv_cross::SPIRType::Half: return "half";
+	case spirv_cross::SPIRType::Float: return "float";
+	case spirv_cross::SPIRType::Double: return "double";
+	case spirv_cross::SPIRType::Image: return "image";
+	case spirv_cross::SPIRType::SampledImage: return "sampled image";
+	case spirv_cross::SPIRType::Sampler: return "sampler";
+	case spirv_cross::SPIRType::AccelerationStructure: return "acceleration structure";
+	default: return "unknown";
+	}
+}
+
+//e.g. "float4x4", "uint3", "Light[16]"
+static string TypeName(const spirv_cross::Compiler& compiler, const spirv_cross::SPIRType& type)
+{
+	string name;
+	if (type.basetype == spirv_cross::SPIRType::Struct)
+	{
+		name = compiler.get_name(type.self);
+		if (name.empty())
+		{
+			name = "struct";
+		}
+	}
+	else
+	{
+		name = ScalarName(type.basetype);
+		if (type.columns > 1)
+		{
+			name += to_string(type.columns) + "x" + to_string(type.vecsize);
+		}
+		else if (type.vecsize > 1)
+		{
+			name += to_string(type.vecsize);
+		}
+	}
+
+	//the outermost dimension is stored last
+	for (size_t dimension = type.array.size(); dimension > 0; dimension--)
+	{
+		if (!type.array_size_literal[dimension - 1])
+		{
+			name += "[spec]";
+		}
+		else if (type.array[dimension - 1] == 0)
+		{
+			name += "[]";
+		}
+		else
+		{
+			name += "[" + to_string(type.array[dimension - 1]) + "]";
+		}
+	}
+	return name;
+}
+
+static bool IsBlock(resourceKind_t kind)
+{
+	return kind == uniformBuffer || kind == storageBuffer || kind == pushConstantBuffer;
+}
+
+static Json::Value OptionalValue(uint32_t value)
+{
+	return value == reflectionIndex_t::unassigned ? Json::Value() : Json::Value(value);
+}
+
+// -------------------------------------------------------- Reflection index -----------------------------------------------
+
+const char* reflectionIndex_t::KindName(resourceKind_t kind)
+{
+	return kind < numResourceKinds ? resourceKindNames[kind] : "unknown";
+}
+
+void reflectionIndex_t::Clear()
+{
+	resources.clear();
+	members.clear();
+	resourceLookup.clear();
+	memberLookup.clear();
+}
+
+void reflectionIndex_t::Build(const spirv_cross::Compiler& compiler, const spirv_cross::ShaderResources& shaderResources)
+{
+	Clear();
+	AddResources(compiler, atomicCounter, shaderResources.atomic_counters);
+	AddResources(compiler, pushConstantBuffer, shaderResources.push_constant_buffers);
+	AddResources(compiler, sampledImage, shaderResources.sampled_images);
+	AddResources(compiler, stageInput, shaderResources.stage_inputs);
+	AddResources(compiler, stageOutput, shaderResources.stage_outputs);
+	AddResources(compiler, storageBuffer, shaderResources.storage_buffers);
+	AddResources(compiler, storageImage, shaderResources.storage_images);
+	AddResources(compiler, subpassInput, shaderResources.subpass_inputs);
+	AddResources(compiler, uniformBuffer, shaderResources.uniform_buffers);
+	AddResources(compiler, separateImage, shaderResources.separate_images);
+	AddResources(compiler, separateSampler, shaderResources.separate_samplers);
+	AddResources(compiler, accelerationStructure, shaderResources.acceleration_structures);
+
+	//lookups are built last so the strings they copy are final
+	resourceLookup.reserve(resources.size());
+	for (uint32_t resourceIter = 0; resourceIter < resources.size(); resourceIter++)
+	{
+		resourceLookup.emplace(resources[resourceIter].name, resourceIter);
+	}
+	memberLookup.reserve(members.size());
+	for (uint32_t memberIter = 0; memberIter < members.size(); memberIter++)
+	{
+		const blockMember_t& member = members[memberIter];
+		memberLookup.emplace(resources[member.resource].name + "." + member.name, memberIter);
+	}
+}
+
+void reflectionIndex_t::AddResources(const spirv_cross::Compiler& compiler, resourceKind_t kind, const spirv_cross::SmallVector<spirv_cross::Resource>& list)
+{
+	for (const spirv_cross::Resource& resource : list)
+	{
+		reflectedResource_t reflected = {};
+		reflected.kind = kind;
+		reflected.name = resource.name.empty() ? compiler.get_fallback_name(resource.id) : resource.name;
+		reflected.id = resource.id;
+		reflected.typeID = resource.type_id;
+		reflected.baseTypeID = resource.base_type_id;
+		reflected.typeName = TypeName(compiler, compiler.get_type(resource.type_id));
+
+		if (compiler.has_decoration(resource.id, spv::DecorationDescriptorSet))
+			reflected.set = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+		if (compiler.has_decoration(resource.id, spv::DecorationBinding))
+			reflected.binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+		if (compiler.has_decoration(resource.id, spv::DecorationLocation))
+			reflected.location = compiler.get_decoration(resource.id, spv::DecorationLocation);
+
+		uint32_t resourceIndex = (uint32_t)resources.size();
+		const spirv_cross::SPIRType& baseType = compiler.get_type(resource.base_type_id);
+		reflected.firstMember = (uint32_t)members.size();
+		if (baseType.basetype == spirv_cross::SPIRType::Struct && !baseType.member_types.empty())
+		{
+			bool hasLayout = IsBlock(kind);
+			if (hasLayout)
+			{
+				reflected.size = (uint32_t)compiler.get_declared_struct_size(baseType);
+			}
+			AddMembers(compiler, baseType, string(), 0, 0, resourceIndex, hasLayout);
+		}
+		reflected.memberCount = (uint32_t)members.size() - reflected.firstMember;
+		resources.push_back(std::move(reflected));
+	}
+}
+
+void reflectionIndex_t::AddMembers(const spirv_cross::Compiler& compiler, const spirv_cross::SPIRType& structType, const string& prefix,
+	uint32_t baseOffset, uint32_t depth, uint32_t resource, bool hasLayout)
+{
+	for (uint32_t memberIter = 0; memberIter < structType.member_types.size(); memberIter++)
+	{
+		const spirv_cross::SPIRType& memberType = compiler.get_type(structType.member_types[memberIter]);
+		string memberName = compiler.get_member_name(structType.self, memberIter);
+		if (memberName.empty())
+		{
+			memberName = "_m" + to_string(memberIter);
+		}
+
+		blockMember_t member = {};
+		member.name = prefix.empty() ? memberName : prefix + "." + memberName;
+		member.typeName = TypeName(compiler, memberType);
+		member.typeID = structType.member_types[memberIter];
+		member.resource = resource;
+		member.depth = depth;
+
+		//blocks are required to carry explicit layout decorations, interface structs do not
+		if (hasLayout)
+		{
+			member.offset = baseOffset + compiler.type_struct_member_offset(structType, memberIter);
+			member.size = (uint32_t)compiler.get_declared_struct_member_size(structType, memberIter);
+			if (!memberType.array.empty())
+			{
+				member.arrayStride = compiler.type_struct_member_array_stride(structType, memberIter);
+			}
+			if (memberType.columns > 1)
+			{
+				member.matrixStride = compiler.type_struct_member_matrix_stride(structType, memberIter);
+			}
+		}
+
+		uint32_t memberOffset = member.offset;
+		string memberPath = member.name;
+		members.push_back(std::move(member));
+
+		//nested structs are expanded once, for the first array element
+		if (memberType.basetype == spirv_cross::SPIRType::Struct && !memberType.member_types.empty())
+		{
+			for (size_t dimension = 0; dimension < memberType.array.size(); dimension++)
+			{
+				memberPath += "[0]";
+			}
+			AddMembers(compiler, memberType, memberPath, memberOffset, depth + 1, resource, hasLayout);
+		}
+	}
+}
+
+const reflectedResource_t* reflectionIndex_t::FindResource(const string& name) const
+{
+	auto found = resourceLookup.find(name);
+	return found != resourceLookup.end() ? &resources[found->second] : nullptr;
+}
+
+const blockMember_t* reflectionIndex_t::FindMember(const string& blockName, const string& memberPath) const
+{
+	auto found = memberLookup.find(blockName + "." + memberPath);
+	return found != memberLookup.end() ? &members[found->second] : nullptr;
+}
+
+void reflectionIndex_t::SearchMembers(uint32_t resource, const string& text, vector<uint32_t>& matches) const
+{
+	matches.clear();
+	if (resource >= resources.size())
+	{
+		return;
+	}
+
+	const reflectedResource_t& owner = resources[resource];
+	for (uint32_t memberIter = owner.firstMember; memberIter < owner.firstMember + owner.memberCount; memberIter++)
+	{
+		if (text.empty() || members[memberIter].name.find(text) != string::npos)
+		{
+			matches.push_back(memberIter);
+		}
+	}
+}
+
+Json::Value reflectionIndex_t::ToJson() const
+{
+	Json::Value root(Json::objectValue);
+	for (unsigned int kindIter = 0; kindIter < numResourceKinds; kindIter++)
+	{
+		root[resourceKindNames[kindIter]] = Json::Value(Json::arrayValue);
+	}
+
+	for (const reflectedResource_t& resource : resources)
+	{
+		Json::Value entry(Json::objectValue);
+		entry["name"] = resource.name;
+		entry["type"] = resource.typeName;
+		entry["id"] = resource.id;
+		entry["type_id"] = resource.typeID;
+		entry["base_type_id"] = resource.baseTypeID;
+		entry["set"] = OptionalValue(resource.set);
+		entry["binding"] = OptionalValue(resource.binding);
+		entry["location"] = OptionalValue(resource.location);
+		if (IsBlock(resource.kind))
+		{
+			entry["size"] = resource.size;
+		}
+
+		if (resource.memberCount > 0)
+		{
+			Json::Value memberList(Json::arrayValue);
+			for (uint32_t memberIter = resource.firstMember; memberIter < resource.firstMember + resource.memberCount; memberIter++)
+			{
+				const blockMember_t& member = members[memberIter];
+				Json::Value memberEntry(Json::objectValue);
+				memberEntry["name"] = member.name;
+				memberEntry["type"] = member.typeName;
+				memberEntry["depth"] = member.depth;
+				if (IsBlock(resource.kind))
+				{
+					memberEntry["offset"] = member.offset;
+					memberEntry["size"] = member.size;
+					memberEntry["array_stride"] = member.arrayStride;
+					memberEntry["matrix_stride"] = member.matrixStride;
+				}
+				memberList.append(std::move(memberEntry));
+			}
+			entry["members"] = std::move(memberList);
+		}
+		root[resourceKindNames[resource.kind]].append(std::move(entry));
+	}
+	return root;
+}